@@ -0,0 +1,79 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "include/arena.h"
+
+/** Size of a chunk header (keeps the first block of the chunk aligned) */
+#define CHUNK_HDR                                                              \
+  ((sizeof(Arena_Chunk_t) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+/* PRIVATE */
+static Arena_t frame; // scratch data of the current frame
+
+static Arena_Chunk_t*
+arena_new_chunk(Arena_t* arena, size_t size)
+{
+  Arena_Chunk_t* chunk = (Arena_Chunk_t*)malloc(CHUNK_HDR + size);
+  if (!chunk)
+    return NULL;
+
+  chunk->next   = arena->chunks;
+  chunk->size   = size;
+  chunk->used   = 0;
+  arena->chunks = chunk;
+  arena->total += size;
+  return chunk;
+}
+
+/* PUBLIC */
+Arena_t*
+frame_arena(void)
+{
+  return &frame;
+}
+
+void*
+arena_alloc(Arena_t* arena, size_t size)
+{
+  size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+  Arena_Chunk_t* chunk = arena->chunks;
+  if (!chunk || chunk->size - chunk->used < size) {
+    chunk = arena_new_chunk(
+      arena, size > DFLT_ARENA_CHUNK ? size : DFLT_ARENA_CHUNK);
+    if (!chunk)
+      return NULL;
+  }
+
+  void* block = (uint8_t*)chunk + CHUNK_HDR + chunk->used;
+  chunk->used += size;
+  return block;
+}
+
+void
+arena_reset(Arena_t* arena)
+{
+  if (!arena->chunks)
+    return;
+
+  if (!arena->chunks->next) { // a single chunk: just rewind it
+    arena->chunks->used = 0;
+    return;
+  }
+
+  /* coalesce the chunks into one (if that fails, the arena is left empty) */
+  size_t total = arena->total;
+  arena_free(arena);
+  arena_new_chunk(arena, total);
+}
+
+void
+arena_free(Arena_t* arena)
+{
+  while (arena->chunks) {
+    Arena_Chunk_t* next = arena->chunks->next;
+    free(arena->chunks);
+    arena->chunks = next;
+  }
+  arena->total = 0;
+}
@@ -5,6 +5,7 @@
 
 #include "include/bmp.h"
 #include "include/err_utils.h"
+#include "include/game_opts.h"
 #include "include/utils.h"
 
 static inline float
@@ -13,9 +14,89 @@ applymtr(const float* const mtr_row, const float* const point)
   return (mtr_row[0] * point[0] + mtr_row[1] * point[1]);
 }
 
+static void
+new_sprite_spans(Sprite_t* sprite)
+{
+  /* runs of opaque (8 bit) pixels of each row, so drawing and collision tests
+   * only visit the opaque parts of the sprite */
+  sprite->Spans = NULL;
+
+  /* count the spans first (everything goes in a single block) */
+  size_t num_spans  = 0;
+  uint8_t* data_ptr = sprite->Data;
+  for (size_t y = 0; y < sprite->Height; ++y) {
+    bool in_span = false;
+    for (size_t x = 0; x < sprite->Width; ++x, ++data_ptr) {
+      bool opaque = *data_ptr != DFLT_TRANSP;
+      if (opaque && !in_span)
+        ++num_spans;
+      in_span = opaque;
+    }
+  }
+
+  Sprite_Spans_t* spans = (Sprite_Spans_t*)malloc(
+    sizeof(Sprite_Spans_t) + (sprite->Height + 1) * sizeof(uint32_t) +
+    num_spans * sizeof(Sprite_Span_t));
+  if (!spans)
+    return; // drawing and collision tests fall back to the whole sprite
+
+  static uint32_t last_id = 0; // ids tell the renderer the pixels apart
+  if (!++last_id)
+    ++last_id; // 0 is never used (wrapped around)
+
+  spans->Transp   = DFLT_TRANSP;
+  spans->Id       = last_id;
+  spans->RowStart = (uint32_t*)(spans + 1);
+  spans->Spans    = (Sprite_Span_t*)(spans->RowStart + sprite->Height + 1);
+
+  Sprite_Span_t* span = spans->Spans;
+  data_ptr            = sprite->Data;
+  for (size_t y = 0; y < sprite->Height; ++y) {
+    spans->RowStart[y] = span - spans->Spans;
+    for (size_t x = 0; x < sprite->Width;) {
+      if (data_ptr[x] == DFLT_TRANSP) {
+        ++x;
+        continue;
+      }
+
+      span->Start = x;
+      while (x < sprite->Width && data_ptr[x] != DFLT_TRANSP)
+        ++x;
+      span->Len = x - span->Start;
+      ++span;
+    }
+    data_ptr += sprite->Width;
+  }
+  spans->RowStart[sprite->Height] = span - spans->Spans;
+
+  sprite->Spans = spans;
+}
+
+/* get the spans of a sprite row (a sprite without spans, or a NULL one, is
+ * solid: a single span as wide as the given width) */
+static inline const Sprite_Span_t*
+sprite_row_spans(Sprite_t* sprite,
+                 size_t y,
+                 uint16_t width,
+                 Sprite_Span_t* solid,
+                 const Sprite_Span_t** end)
+{
+  if (!sprite || !sprite->Spans) {
+    solid->Start = 0;
+    solid->Len   = width;
+    *end         = solid + 1;
+    return solid;
+  }
+
+  *end = sprite->Spans->Spans + sprite->Spans->RowStart[y + 1];
+  return sprite->Spans->Spans + sprite->Spans->RowStart[y];
+}
+
 static int
 load_bmp(FILE* fp, Sprite_t* sprite)
 {
+  sprite->Spans = NULL;
+
   /* read BMP file header */
   BMPFileHeader_t file_header;
   fread((char*)&file_header, sizeof(BMPFileHeader_t), 1, fp);
@@ -85,6 +166,7 @@ load_bmp(FILE* fp, Sprite_t* sprite)
     }
   }
 
+  new_sprite_spans(sprite);
   return 0;
 }
 
@@ -165,6 +247,7 @@ shearX_sprite(Sprite_t* ori_sprite, float shear)
     }
   }
 
+  new_sprite_spans(shear_sprite);
   return shear_sprite;
 }
 
@@ -220,6 +303,7 @@ shearY_sprite(Sprite_t* ori_sprite, float shear)
     }
   }
 
+  new_sprite_spans(shear_sprite);
   return shear_sprite;
 }
 
@@ -282,6 +366,7 @@ rotate_sprite(Sprite_t* ori_sprite, float angle)
     }
   }
 
+  new_sprite_spans(rot_sprite);
   return rot_sprite;
 }
 
@@ -306,8 +391,9 @@ rotate_sprite_intPI(Sprite_t* ori_sprite, int8_t num_turns)
   rot_sprite->Height = ori_sprite->Height;
 
   if (!num_turns) {
-    *rot_data        = *ori_sprite->Data;
+    memcpy(rot_data, ori_sprite->Data, ori_sprite->Width * ori_sprite->Height);
     rot_sprite->Data = rot_data;
+    new_sprite_spans(rot_sprite);
     return rot_sprite;
   }
   rot_sprite->Data = rot_data;
@@ -341,6 +427,7 @@ rotate_sprite_intPI(Sprite_t* ori_sprite, int8_t num_turns)
     }
   }
 
+  new_sprite_spans(rot_sprite);
   return rot_sprite;
 }
 
@@ -368,6 +455,97 @@ sprite_cpy(Sprite_t* orig)
 
   cpy_sprite->Width  = orig->Width;
   cpy_sprite->Height = orig->Height;
+  new_sprite_spans(cpy_sprite);
 
   return cpy_sprite;
 }
+
+void
+free_sprite(Sprite_t* sprite)
+{
+  free(sprite->Data);
+  sprite->Data = NULL;
+
+  free(sprite->Spans); // a single block
+  sprite->Spans = NULL;
+}
+
+bool
+sprite_spans_overlap_in(Sprite_t* a,
+                        int ax,
+                        int ay,
+                        Sprite_t* b,
+                        int bx,
+                        int by,
+                        int x,
+                        int y,
+                        int w,
+                        int h)
+{
+  /* intersection of both sprites and the given area */
+  int x0 = x, y0 = y, x1 = x + w, y1 = y + h;
+  if (ax > x0)
+    x0 = ax;
+  if (ay > y0)
+    y0 = ay;
+  if (ax + (int)a->Width < x1)
+    x1 = ax + a->Width;
+  if (ay + (int)a->Height < y1)
+    y1 = ay + a->Height;
+  if (b) {
+    if (bx > x0)
+      x0 = bx;
+    if (by > y0)
+      y0 = by;
+    if (bx + (int)b->Width < x1)
+      x1 = bx + b->Width;
+    if (by + (int)b->Height < y1)
+      y1 = by + b->Height;
+  }
+  if (x0 >= x1 || y0 >= y1)
+    return false;
+
+  /* walk both rows' spans in order (a solid area is a single span) */
+  Sprite_Span_t a_solid, b_solid;
+  for (int row = y0; row < y1; ++row) {
+    const Sprite_Span_t *a_end, *b_end;
+    const Sprite_Span_t* a_span =
+      sprite_row_spans(a, row - ay, a->Width, &a_solid, &a_end);
+    const Sprite_Span_t* b_span =
+      sprite_row_spans(b,
+                       b ? row - by : 0,
+                       b ? b->Width : (uint32_t)(x1 - x0),
+                       &b_solid,
+                       &b_end);
+    int b_x = b ? bx : x0;
+
+    while (a_span != a_end && b_span != b_end) {
+      int a_beg = ax + a_span->Start, a_fin = a_beg + a_span->Len;
+      int b_beg = b_x + b_span->Start, b_fin = b_beg + b_span->Len;
+      if (a_beg >= x1 || b_beg >= x1)
+        break; // the remaining spans are past the area
+
+      int beg = a_beg > b_beg ? a_beg : b_beg;
+      int fin = a_fin < b_fin ? a_fin : b_fin;
+      if (beg < x0)
+        beg = x0;
+      if (beg < fin)
+        return true;
+
+      /* advance the span that ends first */
+      if (a_fin < b_fin)
+        ++a_span;
+      else
+        ++b_span;
+    }
+  }
+
+  return false;
+}
+
+bool
+sprite_spans_overlap(Sprite_t* a, int ax, int ay, Sprite_t* b, int bx, int by)
+{
+  return sprite_spans_overlap_in(
+    a, ax, ay, b, bx, by, ax, ay, a->Width, a->Height);
+}
@@ -0,0 +1,435 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "include/bmp.h"
+#include "include/broadphase.h"
+#include "include/collisions.h"
+#include "include/err_utils.h"
+
+/** Default number of entries reserved by a new broadphase grid */
+#define DFLT_BP_ENTRIES 64
+
+/* PRIVATE */
+static inline void
+entry_row_span(const Broadphase_Entry_t* e,
+               size_t y,
+               size_t* beg,
+               size_t* end)
+{
+  /* columns [beg, end[ of the area covered in row y (empty if beg >= end) */
+  *beg = e->x;
+  *end = e->x + e->w;
+  if (e->shape == BP_RECT)
+    return;
+
+  /* band: the row is covered by the consecutive squares [first, last] */
+  size_t row   = y - e->y;
+  size_t first = row + 1 > e->size ? row + 1 - e->size : 0;
+  size_t last  = row < e->len ? row : e->len - 1u;
+  size_t x0    = e->shape == BP_BAND_DOWN ? first : e->len - 1u - last;
+  size_t x1    = e->shape == BP_BAND_DOWN ? last : e->len - 1u - first;
+  if (e->x + x0 > *beg)
+    *beg = e->x + x0;
+  if (e->x + x1 + e->size < *end)
+    *end = e->x + x1 + e->size;
+}
+
+static void
+entry_cells_in_row(const Broadphase_t* bp,
+                   const Broadphase_Entry_t* e,
+                   size_t row,
+                   size_t* col_beg,
+                   size_t* col_end)
+{
+  /* the spans only move one way from line to line: the ones at the first and
+   * last lines inside the row of cells cover all the others */
+  size_t y_beg = row * bp->cell_size > e->y ? row * bp->cell_size : e->y;
+  size_t y_end = (row + 1) * bp->cell_size < (size_t)e->y + e->h
+                   ? (row + 1) * bp->cell_size - 1
+                   : (size_t)e->y + e->h - 1;
+
+  size_t beg, end, beg_last, end_last;
+  entry_row_span(e, y_beg, &beg, &end);
+  entry_row_span(e, y_end, &beg_last, &end_last);
+  if (beg_last < beg)
+    beg = beg_last;
+  if (end_last > end)
+    end = end_last;
+
+  if (beg >= end) { // nothing in this row of cells
+    *col_beg = 1;
+    *col_end = 0;
+    return;
+  }
+  *col_beg = beg / bp->cell_size;
+  *col_end = (end - 1) / bp->cell_size;
+}
+
+static bool
+entries_overlap(const Broadphase_Entry_t* a, const Broadphase_Entry_t* b)
+{
+  /* intersection of both areas */
+  uint16_t x0 = a->x > b->x ? a->x : b->x;
+  uint16_t y0 = a->y > b->y ? a->y : b->y;
+  uint16_t x1 = a->x + a->w < b->x + b->w ? a->x + a->w : b->x + b->w;
+  uint16_t y1 = a->y + a->h < b->y + b->h ? a->y + a->h : b->y + b->h;
+
+  if (x0 >= x1 || y0 >= y1)
+    return false;
+
+  if (a->shape != BP_RECT || b->shape != BP_RECT) {
+    /* bands: look for a line where both spans meet (bands have no sprite) */
+    const Broadphase_Entry_t* s = a->spr ? a : b->spr ? b : NULL;
+    for (size_t y = y0; y < y1; ++y) {
+      size_t beg, end, b_beg, b_end;
+      entry_row_span(a, y, &beg, &end);
+      entry_row_span(b, y, &b_beg, &b_end);
+      if (b_beg > beg)
+        beg = b_beg;
+      if (b_end < end)
+        end = b_end;
+
+      if (beg < end &&
+          (!s || sprite_spans_overlap_in(
+                   s->spr, s->x, s->y, NULL, 0, 0, beg, y, end - beg, 1)))
+        return true;
+    }
+    return false;
+  }
+
+  if (!a->spr && !b->spr)
+    return true;
+
+  /* pixel-exact test (a solid area only needs an opaque pixel of the other) */
+  if (!a->spr)
+    return sprite_spans_overlap_in(
+      b->spr, b->x, b->y, NULL, 0, 0, x0, y0, x1 - x0, y1 - y0);
+  return sprite_spans_overlap_in(
+    a->spr, a->x, a->y, b->spr, b->x, b->y, x0, y0, x1 - x0, y1 - y0);
+}
+
+static void
+broadphase_reset_stamps(Broadphase_t* bp)
+{
+  /* the query stamp wrapped around: forget all the old ones */
+  for (size_t i = 0; i < bp->entries_end; ++i)
+    bp->entries[i].stamp = 0;
+  for (size_t i = 0; i < bp->static_end; ++i)
+    bp->static_entries[i].stamp = 0;
+  bp->stamp = 1;
+}
+
+static inline bool
+static_cell_used(const Broadphase_t* bp, size_t cell_ind)
+{
+  return bp->static_bits &&
+         (bp->static_bits[cell_ind / 32] >> (cell_ind % 32) & 1);
+}
+
+static inline void
+query_candidate(Broadphase_t* bp,
+                const Broadphase_Entry_t* new_entry,
+                Broadphase_Entry_t* cand,
+                Hash_Set_t* already_collided_objs)
+{
+  if (cand->stamp == bp->stamp)
+    return;
+  cand->stamp = bp->stamp;
+
+  if (cand->obj == new_entry->obj ||
+      hash_set_contains(already_collided_objs, cand->obj) ||
+      !entries_overlap(new_entry, cand))
+    return;
+
+  collision_dispatcher(new_entry->obj, cand->obj);
+  hash_set_insert(already_collided_objs, cand->obj);
+}
+
+static int
+broadphase_reserve(Broadphase_t* bp, size_t reserve)
+{
+  if (bp->entries_size >= reserve)
+    return 0;
+
+  Broadphase_Entry_t* new_entries = (Broadphase_Entry_t*)realloc(
+    bp->entries, sizeof(Broadphase_Entry_t) * reserve);
+  if (!new_entries)
+    return 1;
+
+  bp->entries      = new_entries;
+  bp->entries_size = reserve;
+  return 0;
+}
+
+/* PUBLIC */
+Broadphase_t*
+new_broadphase(uint16_t h_res, uint16_t v_res, uint16_t cell_size)
+{
+  if (!cell_size)
+    return NULL;
+
+  Broadphase_t* bp = (Broadphase_t*)malloc(sizeof(Broadphase_t));
+  if (!bp)
+    return NULL;
+
+  bp->h_res     = h_res;
+  bp->v_res     = v_res;
+  bp->cell_size = cell_size;
+  bp->cols      = (h_res + cell_size - 1) / cell_size;
+  bp->rows      = (v_res + cell_size - 1) / cell_size;
+
+  bp->entries      = NULL;
+  bp->entries_end  = 0;
+  bp->entries_size = 0;
+  bp->stamp        = 0;
+
+  bp->static_entries = NULL;
+  bp->static_end     = 0;
+  bp->static_start   = NULL;
+  bp->static_inds    = NULL;
+  bp->static_bits    = NULL;
+  bp->baking         = false;
+  bp->used_cells   = new_vector();
+  bp->cells        = (vector**)calloc(bp->cols * bp->rows, sizeof(vector*));
+  if (!bp->used_cells || !bp->cells ||
+      broadphase_reserve(bp, DFLT_BP_ENTRIES)) {
+    free_broadphase(bp);
+    return NULL;
+  }
+
+  for (size_t i = 0; i < (size_t)bp->cols * bp->rows; ++i) {
+    if (!(bp->cells[i] = new_vector())) {
+      free_broadphase(bp);
+      return NULL;
+    }
+  }
+
+  return bp;
+}
+
+void
+free_broadphase(Broadphase_t* bp)
+{
+  if (!bp)
+    return;
+
+  /* cells only hold indexes (nothing to free inside them) */
+  if (bp->cells) {
+    for (size_t i = 0; i < (size_t)bp->cols * bp->rows; ++i) {
+      if (bp->cells[i]) {
+        free(bp->cells[i]->data);
+        free(bp->cells[i]);
+      }
+    }
+    free(bp->cells);
+  }
+  if (bp->used_cells) {
+    free(bp->used_cells->data);
+    free(bp->used_cells);
+  }
+
+  broadphase_static_clear(bp);
+  free(bp->entries);
+  free(bp);
+}
+
+void
+broadphase_clear(Broadphase_t* bp)
+{
+  while (bp->used_cells->end) {
+    vector* cell = bp->cells[(size_t)vector_end(bp->used_cells)];
+    while (cell->end)
+      vector_pop_back(cell);
+    vector_pop_back(bp->used_cells);
+  }
+
+  bp->entries_end = 0;
+}
+
+void
+broadphase_static_begin(Broadphase_t* bp)
+{
+  broadphase_static_clear(bp);
+  broadphase_clear(bp);
+  bp->baking = true;
+}
+
+int
+broadphase_static_end(Broadphase_t* bp)
+{
+  bp->baking = false;
+  if (!bp->entries_end)
+    return 0; // nothing to bake
+
+  /* move the baked entries (and the cells' indexes) to the static layer */
+  size_t num_cells = (size_t)bp->cols * bp->rows;
+  size_t num_inds  = 0;
+  for (size_t i = 0; i < num_cells; ++i)
+    num_inds += bp->cells[i]->end;
+
+  bp->static_entries = (Broadphase_Entry_t*)malloc(sizeof(Broadphase_Entry_t) *
+                                                   bp->entries_end);
+  bp->static_start = (uint32_t*)malloc(sizeof(uint32_t) * (num_cells + 1));
+  bp->static_inds  = (uint32_t*)malloc(sizeof(uint32_t) * num_inds);
+  bp->static_bits  = (uint32_t*)calloc((num_cells + 31) / 32, sizeof(uint32_t));
+  if (!bp->static_entries || !bp->static_start || !bp->static_inds ||
+      !bp->static_bits) {
+    broadphase_static_clear(bp);
+    broadphase_clear(bp);
+    return 1;
+  }
+
+  memcpy(bp->static_entries,
+         bp->entries,
+         sizeof(Broadphase_Entry_t) * bp->entries_end);
+  bp->static_end = bp->entries_end;
+  for (size_t i = 0; i < bp->static_end; ++i)
+    bp->static_entries[i].stamp = 0;
+
+  size_t ind = 0;
+  for (size_t i = 0; i < num_cells; ++i) {
+    vector* cell        = bp->cells[i];
+    bp->static_start[i] = ind;
+    for (size_t j = 0; j < cell->end; ++j)
+      bp->static_inds[ind++] = (size_t)vector_at(cell, j);
+    if (cell->end)
+      bp->static_bits[i / 32] |= 1u << (i % 32);
+  }
+  bp->static_start[num_cells] = ind;
+
+  broadphase_clear(bp);
+  return 0;
+}
+
+void
+broadphase_static_clear(Broadphase_t* bp)
+{
+  free(bp->static_entries);
+  free(bp->static_start);
+  free(bp->static_inds);
+  free(bp->static_bits);
+  bp->static_entries = NULL;
+  bp->static_start   = NULL;
+  bp->static_inds    = NULL;
+  bp->static_bits    = NULL;
+  bp->static_end     = 0;
+}
+
+static void
+insert_entry(Broadphase_t* bp,
+             const Broadphase_Entry_t* new_entry,
+             Hash_Set_t* already_collided_objs)
+{
+  size_t row_beg = new_entry->y / bp->cell_size;
+  size_t row_end = (new_entry->y + new_entry->h - 1) / bp->cell_size;
+  size_t col_beg, col_end;
+
+  /* narrowphase against every candidate sharing a cell (each visited once).
+   * The static entries of a cell go first (they used to be inserted first) */
+  if (!++bp->stamp)
+    broadphase_reset_stamps(bp);
+  for (size_t row = row_beg; row <= row_end && !bp->baking; ++row) {
+    entry_cells_in_row(bp, new_entry, row, &col_beg, &col_end);
+    for (size_t col = col_beg; col <= col_end; ++col) {
+      size_t cell_ind = row * bp->cols + col;
+      if (static_cell_used(bp, cell_ind)) {
+        for (size_t i = bp->static_start[cell_ind];
+             i < bp->static_start[cell_ind + 1];
+             ++i)
+          query_candidate(bp,
+                          new_entry,
+                          &bp->static_entries[bp->static_inds[i]],
+                          already_collided_objs);
+      }
+
+      vector* cell = bp->cells[cell_ind];
+      for (size_t i = 0; i < cell->end; ++i)
+        query_candidate(bp,
+                        new_entry,
+                        &bp->entries[(size_t)vector_at(cell, i)],
+                        already_collided_objs);
+    }
+  }
+
+  /* store the new entry in the cells it overlaps */
+  if (bp->entries_end == bp->entries_size &&
+      broadphase_reserve(bp, bp->entries_size * 2)) {
+    warn("%s: Not enough memory to grow the broadphase entries", __func__);
+    return;
+  }
+
+  size_t entry_ind             = bp->entries_end++;
+  bp->entries[entry_ind]       = *new_entry;
+  bp->entries[entry_ind].stamp = bp->stamp;
+  for (size_t row = row_beg; row <= row_end; ++row) {
+    entry_cells_in_row(bp, new_entry, row, &col_beg, &col_end);
+    for (size_t col = col_beg; col <= col_end; ++col) {
+      size_t cell_ind = row * bp->cols + col;
+      if (!bp->cells[cell_ind]->end)
+        vector_push_back(bp->used_cells, (void*)cell_ind);
+      vector_push_back(bp->cells[cell_ind], (void*)entry_ind);
+    }
+  }
+}
+
+void
+broadphase_insert(Broadphase_t* bp,
+                  void* obj,
+                  uint16_t x,
+                  uint16_t y,
+                  uint16_t w,
+                  uint16_t h,
+                  Sprite_t* spr,
+                  Hash_Set_t* already_collided_objs)
+{
+  if (x >= bp->h_res || y >= bp->v_res || !w || !h)
+    return;
+
+  /* clip the area to the screen */
+  Broadphase_Entry_t new_entry = { .obj   = obj,
+                                   .x     = x,
+                                   .y     = y,
+                                   .w     = w,
+                                   .h     = h,
+                                   .spr   = spr,
+                                   .stamp = 0,
+                                   .shape = BP_RECT };
+  if (new_entry.w > bp->h_res - x)
+    new_entry.w = bp->h_res - x;
+  if (new_entry.h > bp->v_res - y)
+    new_entry.h = bp->v_res - y;
+
+  insert_entry(bp, &new_entry, already_collided_objs);
+}
+
+void
+broadphase_insert_band(Broadphase_t* bp,
+                       void* obj,
+                       uint16_t x,
+                       uint16_t y,
+                       uint16_t len,
+                       uint16_t size,
+                       bool down,
+                       Hash_Set_t* already_collided_objs)
+{
+  if (x >= bp->h_res || y >= bp->v_res || !len || !size)
+    return;
+
+  /* clip the bounding box to the screen (the band is clipped along) */
+  Broadphase_Entry_t new_entry = { .obj   = obj,
+                                   .x     = x,
+                                   .y     = y,
+                                   .w     = len - 1 + size,
+                                   .h     = len - 1 + size,
+                                   .spr   = NULL,
+                                   .stamp = 0,
+                                   .shape = down ? BP_BAND_DOWN : BP_BAND_UP,
+                                   .len   = len,
+                                   .size  = size };
+  if (new_entry.w > bp->h_res - x)
+    new_entry.w = bp->h_res - x;
+  if (new_entry.h > bp->v_res - y)
+    new_entry.h = bp->v_res - y;
+
+  insert_entry(bp, &new_entry, already_collided_objs);
+}
@@ -3,34 +3,52 @@
 #include "include/err_utils.h"
 #include "include/food.h"
 #include "include/missile.h"
+#include "include/obj_handle.h"
 #include "include/skane.h"
 #include "include/wall.h"
 
+/* PRIVATE */
+/** @struct COLLISION_HANDLER_T
+ *  Handler of the collisions between two types of objects.
+ */
+typedef struct COLLISION_HANDLER_T
+{
+  void (*handle)(void*, void*); /**< Handles a collision (NULL if none). */
+  bool swapped;                 /**< Handler takes (obj2, obj1). */
+} Collision_Handler_t;
+
 static void
-missile_and_wall_collision(Missle_t* missile, Wall_t* wall)
+missile_and_wall_collision(void* mis, void* w)
 {
-  missile->obj->identifier.id = 0;
-  // remove_object(missile->obj->identifier.id, missile->obj->identifier.type);
+  Missle_t* missile = (Missle_t*)mis;
+
+  kill_object(missile->obj);
 }
 
 static void
-missle_and_enemy_collision(Missle_t* missile, Enemy_t* enemy)
+missle_and_enemy_collision(void* mis, void* ene)
 {
+  Missle_t* missile = (Missle_t*)mis;
+  Enemy_t* enemy    = (Enemy_t*)ene;
+
   /* check if missle isn't shooting allies */
   if (missile->my_ska == enemy->ska->obj->identifier.id) {
-    missile->obj->identifier.id = 0;
+    kill_object(missile->obj);
     enemy_take_damage(enemy, missile->damage);
   }
 }
 
 static void
-missle_and_skabody_collision(Missle_t* missile, Skane_Body_t* ska_body)
+missle_and_skabody_collision(void* mis, void* body)
 {
+  Missle_t* missile      = (Missle_t*)mis;
+  Skane_Body_t* ska_body = (Skane_Body_t*)body;
+
   /* check if missle isn't shooting own skane */
   Skane_t* ska = (Skane_t*)ska_body->ska;
   if (ska->obj->identifier.id != missile->my_ska) {
     /* destroy missle (set for garbage collection) */
-    missile->obj->identifier.id = 0;
+    kill_object(missile->obj);
 
     /* Enemy hits skane */
     skane_take_damage(ska_body->ska, missile->damage / 2);
@@ -38,8 +56,11 @@ missle_and_skabody_collision(Missle_t* missile, Skane_Body_t* ska_body)
 }
 
 static void
-enemy_and_wall_collision(Enemy_t* enemy, Wall_t* wall)
+enemy_and_wall_collision(void* ene, void* w)
 {
+  Enemy_t* enemy = (Enemy_t*)ene;
+  Wall_t* wall   = (Wall_t*)w;
+
   if (wall->type == VERT_WALL) {
     if (enemy->obj->x > wall->obj->x) { // wall is at the left
       if (enemy->obj->x + enemy->obj->speed_x <
@@ -67,8 +88,11 @@ enemy_and_wall_collision(Enemy_t* enemy, Wall_t* wall)
 }
 
 static void
-skane_and_enemy_collision(Skane_t* skane, Enemy_t* enemy)
+skane_and_enemy_collision(void* ska, void* ene)
 {
+  Skane_t* skane = (Skane_t*)ska;
+  Enemy_t* enemy = (Enemy_t*)ene;
+
   if (!enemy->is_attacking &&
       enemy->ska->obj->identifier.id == skane->obj->identifier.id) {
     enemy->is_attacking = true;
@@ -80,12 +104,15 @@ skane_and_enemy_collision(Skane_t* skane, Enemy_t* enemy)
 }
 
 static void
-skane_and_missle_collision(Skane_t* skane, Missle_t* missle)
+skane_and_missle_collision(void* ska, void* mis)
 {
+  Skane_t* skane   = (Skane_t*)ska;
+  Missle_t* missle = (Missle_t*)mis;
+
   /* check if missle isn't shooting own skane */
   if (skane->obj->identifier.id != missle->my_ska) {
     /* destroy missle (set for garbage collection) */
-    missle->obj->identifier.id = 0;
+    kill_object(missle->obj);
 
     /* Missle hits skane */
     skane_take_damage(skane, missle->damage);
@@ -93,15 +120,21 @@ skane_and_missle_collision(Skane_t* skane, Missle_t* missle)
 }
 
 static void
-skane_and_food_collision(Skane_t* skane, Food_t* food)
+skane_and_food_collision(void* ska, void* f)
 {
+  Skane_t* skane = (Skane_t*)ska;
+  Food_t* food   = (Food_t*)f;
+
   skane_nom(skane, food->nourishment);
-  food->obj->identifier.id = 0; // Tag to be destroyed
+  kill_object(food->obj); // Tag to be destroyed
 }
 
 static void
-skane_and_wall_collision(Skane_t* skane, Wall_t* wall)
+skane_and_wall_collision(void* ska, void* w)
 {
+  Skane_t* skane = (Skane_t*)ska;
+  Wall_t* wall   = (Wall_t*)w;
+
   if (wall->type == VERT_WALL) {
     if (skane->obj->x > wall->obj->x) { // if at left
       if (skane->curr_state == W || skane->curr_state == NW ||
@@ -129,8 +162,11 @@ skane_and_wall_collision(Skane_t* skane, Wall_t* wall)
 }
 
 static void
-skane_and_skane_collision(Skane_t* ska1, Skane_t* ska2)
+skane_and_skane_collision(void* s1, void* s2)
 {
+  Skane_t* ska1 = (Skane_t*)s1;
+  Skane_t* ska2 = (Skane_t*)s2;
+
   if (!ska1->has_col_skane && !ska2->has_col_skane) {
     if (ska1->curr_state != STOP)
       skane_take_damage(ska1, ska2->damage);
@@ -143,12 +179,15 @@ skane_and_skane_collision(Skane_t* ska1, Skane_t* ska2)
 }
 
 static void
-skane_and_skabody_collision(Skane_t* ska, Skane_Body_t* skabody)
+skane_and_skabody_collision(void* s, void* body)
 {
+  Skane_t* ska          = (Skane_t*)s;
+  Skane_Body_t* skabody = (Skane_Body_t*)body;
+
   /* If skane which collided is smaller, kill it */
   if (ska->curr_state != STOP && !ska->has_col_skane &&
       ska->health < ((Skane_t*)skabody->ska)->health) {
-    ska->obj->identifier.id = 0;
+    kill_object(ska->obj);
   }
   /* else { // TODO */
     /* ska->has_col_skane                      = 2; */
@@ -157,8 +196,11 @@ skane_and_skabody_collision(Skane_t* ska, Skane_Body_t* skabody)
 }
 
 static void
-enemy_and_enemy_collision(Enemy_t* ene1, Enemy_t* ene2)
+enemy_and_enemy_collision(void* e1, void* e2)
 {
+  Enemy_t* ene1 = (Enemy_t*)e1;
+  Enemy_t* ene2 = (Enemy_t*)e2;
+
   /* can only collide with allies */
   if (ene1->ska->obj->identifier.id == ene2->ska->obj->identifier.id &&
       !ene1->collided_ene && !ene2->collided_ene) {
@@ -170,6 +212,29 @@ enemy_and_enemy_collision(Enemy_t* ene1, Enemy_t* ene2)
   }
 }
 
+/* handler of each pair of types (and whether it takes the objects swapped) */
+static const Collision_Handler_t handlers[NOT_SET][NOT_SET] = {
+  [MISSILE][WALL]       = { missile_and_wall_collision, false },
+  [MISSILE][ENEMY]      = { missle_and_enemy_collision, false },
+  [MISSILE][SKANE_BODY] = { missle_and_skabody_collision, false },
+  [MISSILE][SKANE]      = { skane_and_missle_collision, true },
+  [SKANE][WALL]         = { skane_and_wall_collision, false },
+  [SKANE][ENEMY]        = { skane_and_enemy_collision, false },
+  [SKANE][FOOD]         = { skane_and_food_collision, false },
+  [SKANE][MISSILE]      = { skane_and_missle_collision, false },
+  [SKANE][SKANE]        = { skane_and_skane_collision, false },
+  [SKANE][SKANE_BODY]   = { skane_and_skabody_collision, false },
+  [WALL][MISSILE]       = { missile_and_wall_collision, true },
+  [WALL][ENEMY]         = { enemy_and_wall_collision, true },
+  [ENEMY][MISSILE]      = { missle_and_enemy_collision, true },
+  [ENEMY][SKANE]        = { skane_and_enemy_collision, true },
+  [ENEMY][WALL]         = { enemy_and_wall_collision, false },
+  [ENEMY][ENEMY]        = { enemy_and_enemy_collision, false },
+  [FOOD][SKANE]         = { skane_and_food_collision, true },
+  [SKANE_BODY][MISSILE] = { missle_and_skabody_collision, true },
+  [SKANE_BODY][SKANE]   = { skane_and_skabody_collision, true },
+};
+
 void
 collision_dispatcher(void* obj1, void* obj2)
 {
@@ -182,100 +247,14 @@ collision_dispatcher(void* obj1, void* obj2)
 
   obj_type obj_t1 = ((Derived_obj_t*)obj1)->obj->identifier.type;
   obj_type obj_t2 = ((Derived_obj_t*)obj2)->obj->identifier.type;
-  switch (obj_t1) {
-    case MISSILE:
-      switch (obj_t2) {
-        case WALL:
-          missile_and_wall_collision(obj1, obj2);
-          break;
-        case ENEMY:
-          missle_and_enemy_collision(obj1, obj2);
-          break;
-        case SKANE_BODY:
-          missle_and_skabody_collision(obj1, obj2);
-          break;
-        case SKANE:
-          skane_and_missle_collision(obj2, obj1);
-          break;
-        default:
-          break;
-      }
-      break;
-    case SKANE:
-      switch (obj_t2) {
-        case WALL:
-          skane_and_wall_collision(obj1, obj2);
-          break;
-        case ENEMY:
-          skane_and_enemy_collision(obj1, obj2);
-          break;
-        case FOOD:
-          skane_and_food_collision(obj1, obj2);
-          break;
-        case MISSILE:
-          skane_and_missle_collision(obj1, obj2);
-          break;
-        case SKANE:
-          skane_and_skane_collision(obj1, obj2);
-          break;
-        case SKANE_BODY:
-          skane_and_skabody_collision(obj1, obj2);
-        default:
-          break;
-      }
-      break;
-    case WALL:
-      switch (obj_t2) {
-        case MISSILE:
-          missile_and_wall_collision(obj2, obj1);
-          break;
-        case ENEMY:
-          enemy_and_wall_collision(obj2, obj1);
-          break;
-        default:
-          break;
-      }
-      break;
-    case ENEMY:
-      switch (obj_t2) {
-        case MISSILE:
-          missle_and_enemy_collision(obj2, obj1);
-          break;
-        case SKANE:
-          skane_and_enemy_collision(obj2, obj1);
-          break;
-        case WALL:
-          enemy_and_wall_collision(obj1, obj2);
-          break;
-        case ENEMY:
-          enemy_and_enemy_collision(obj1, obj2);
-          break;
-        default:
-          break;
-      }
-      break;
-    case FOOD:
-      switch (obj_t2) {
-        case SKANE:
-          skane_and_food_collision(obj2, obj1);
-          break;
-        default:
-          break;
-      }
-      break;
-    case SKANE_BODY:
-      switch (obj_t2) {
-        case MISSILE:
-          missle_and_skabody_collision(obj2, obj1);
-          break;
-        case SKANE:
-          skane_and_skabody_collision(obj2, obj1);
-          break;
-        default:
-          break;
-      }
-      break;
-    default:
-      break;
-  }
+  if (obj_t1 >= NOT_SET || obj_t2 >= NOT_SET)
+    return; // menus and untyped objects never collide
+
+  const Collision_Handler_t* handler = &handlers[obj_t1][obj_t2];
+  if (!handler->handle)
+    return; // these types don't interact
+  if (handler->swapped)
+    handler->handle(obj2, obj1);
+  else
+    handler->handle(obj1, obj2);
 }
@@ -56,10 +56,10 @@ destroyCursor(void* cursor)
 }
 
 static void
-updateCollisionCursor(void* cursor, vector* col_matrix)
+updateCollisionCursor(void* cursor, Broadphase_t* col_grid)
 {
   Cursor_t* c = (Cursor_t*)cursor;
-  c->obj->vtable->updateCollision(cursor, col_matrix);
+  c->obj->vtable->updateCollision(cursor, col_grid);
 }
 
 const static Object_Vtable_t cursor_vtable = { .draw    = renderCursor,
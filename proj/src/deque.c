@@ -0,0 +1,162 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "include/deque.h"
+
+/* PRIVATE */
+static inline char*
+deque_slot(Deque_t* deque, size_t pos)
+{
+  return deque->data + (pos & (deque->capacity - 1)) * deque->elem_size;
+}
+
+static int
+deque_grow(Deque_t* deque)
+{
+  /* double the ring buffer, unwrapping the elements to its start */
+  size_t n   = deque_size(deque);
+  char* data = (char*)malloc(2 * deque->capacity * deque->elem_size);
+  if (!data)
+    return 1;
+
+  size_t ind   = deque->front & (deque->capacity - 1);
+  size_t first = deque->capacity - ind; // elements until the buffer wraps
+  if (first > n)
+    first = n;
+
+  memcpy(data, deque->data + ind * deque->elem_size, first * deque->elem_size);
+  memcpy(data + first * deque->elem_size,
+         deque->data,
+         (n - first) * deque->elem_size);
+  free(deque->data);
+
+  deque->data     = data;
+  deque->capacity = 2 * deque->capacity;
+  deque->front    = 0;
+  deque->back     = n;
+  return 0;
+}
+
+/* PUBLIC */
+Deque_t*
+new_deque(size_t elem_size)
+{
+  Deque_t* deque = (Deque_t*)malloc(sizeof(Deque_t));
+  if (!deque)
+    return NULL;
+
+  deque->data = (char*)malloc(DFLT_DEQUE_SIZE * elem_size);
+  if (!deque->data) {
+    free(deque);
+    return NULL;
+  }
+
+  deque->elem_size = elem_size;
+  deque->capacity  = DFLT_DEQUE_SIZE;
+  deque->front     = 0;
+  deque->back      = 0;
+
+  return deque;
+}
+
+void
+free_deque(Deque_t* deque)
+{
+  if (!deque)
+    return;
+
+  free(deque->data);
+  free(deque);
+}
+
+size_t
+deque_size(Deque_t* deque)
+{
+  return deque->back - deque->front;
+}
+
+bool
+deque_empty(Deque_t* deque)
+{
+  return deque->front == deque->back;
+}
+
+void*
+deque_at(Deque_t* deque, size_t i)
+{
+  if (i >= deque_size(deque))
+    return NULL;
+
+  return deque_slot(deque, deque->front + i);
+}
+
+void*
+deque_front(Deque_t* deque)
+{
+  return deque_at(deque, 0);
+}
+
+void*
+deque_back(Deque_t* deque)
+{
+  if (deque_empty(deque))
+    return NULL;
+
+  return deque_slot(deque, deque->back - 1);
+}
+
+void*
+deque_push_front(Deque_t* deque)
+{
+  if (deque_size(deque) == deque->capacity && deque_grow(deque))
+    return NULL;
+
+  --deque->front;
+  return deque_slot(deque, deque->front);
+}
+
+void*
+deque_push_back(Deque_t* deque)
+{
+  if (deque_size(deque) == deque->capacity && deque_grow(deque))
+    return NULL;
+
+  ++deque->back;
+  return deque_slot(deque, deque->back - 1);
+}
+
+void
+deque_pop_front(Deque_t* deque)
+{
+  if (!deque_empty(deque))
+    ++deque->front;
+}
+
+void
+deque_pop_back(Deque_t* deque)
+{
+  if (!deque_empty(deque))
+    --deque->back;
+}
+
+void
+deque_clear(Deque_t* deque)
+{
+  deque->front = 0;
+  deque->back  = 0;
+}
+
+void*
+deque_next(Deque_t* deque, void* elem)
+{
+  if (!elem)
+    return deque_front(deque);
+
+  /* position of the element (from the front) in the ring */
+  size_t ind = ((char*)elem - deque->data) / deque->elem_size;
+  size_t i   = (ind - deque->front) & (deque->capacity - 1);
+  if (i + 1 >= deque_size(deque))
+    return NULL;
+
+  return deque_slot(deque, deque->front + i + 1);
+}
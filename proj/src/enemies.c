@@ -5,50 +5,12 @@
 #include "include/obj_handle.h"
 #include "include/food.h"
 
-/* VIRTUAL FUNCTIONS */
-static void
-printEnemy(void* enem)
-{
-  Enemy_t* enemy = (Enemy_t*)enem;
-  enemy->obj->vtable->print(enemy->obj);
-  warn("HEALTH: %u DAMAGE: %u SKANE_ID: %d",
-       enemy->health,
-       enemy->damage,
-       enemy->ska->obj->identifier.id);
-}
-
-static void
-updateEnemyPos(void* enem)
-{
-  Enemy_t* enemy = (Enemy_t*)enem;
-
-  /* get movement direction */
-  if (!enemy->is_attacking) {
-    float del_x = enemy->ska->obj->x + enemy->ska->obj->sprite.Width / 2 -
-                  (enemy->obj->x + enemy->obj->sprite.Width / 2);
-    float del_y = enemy->ska->obj->y + enemy->ska->obj->sprite.Height / 2 -
-                  (enemy->obj->y + enemy->obj->sprite.Height / 2);
-
-    if (del_x || del_y) {
-      float norm          = sqrt(del_x * del_x + del_y * del_y);
-      enemy->obj->speed_x = (float)del_x / norm * enemy->speed;
-      enemy->obj->speed_y = (float)del_y / norm * enemy->speed;
-
-      enemy->obj->vtable->updatePos(enemy->obj);
-    }
-  }
-
-  if (enemy->is_attacking)
-    --enemy->curr_attack;
-  if (enemy->curr_attack == 0)
-    enemy->is_attacking = false;
-}
-
+/* PRIVATE */
+/* cycle the animation. Done on every step (drawn or not), because the
+ * collisions and the steering use the enemy's sprite */
 static void
-renderEnemy(void* enem)
+animate_enemy(Enemy_t* e)
 {
-  Enemy_t* e = (Enemy_t*)enem;
-
   /* cycle animation */
   if (e->is_attacking) {
     e->obj->anim_cnt = 0;
@@ -83,25 +45,47 @@ renderEnemy(void* enem)
     if (e->obj->anim_cnt == 6 * ENE_ANIMCYCLE_T)
       e->obj->anim_cnt = 0;
   }
+}
+
+/* VIRTUAL FUNCTIONS */
+static void
+printEnemy(void* enem)
+{
+  Enemy_t* enemy = (Enemy_t*)enem;
+  enemy->obj->vtable->print(enemy->obj);
+  warn("HEALTH: %u DAMAGE: %u SKANE_ID: %u",
+       enemy->health,
+       enemy->damage,
+       enemy->ska->obj->identifier.id);
+}
 
+static void
+updateEnemyPos(void* enem)
+{
+  update_enemies(&enem, 1);
+}
+
+static void
+renderEnemy(void* enem)
+{
+  Enemy_t* e = (Enemy_t*)enem;
   e->obj->vtable->draw(e->obj);
 }
 
 static void
 destroyEnemy(void* enem)
 {
-  Enemy_t* e = (Enemy_t*)enem;
-  e->obj->vtable->destroy(e->obj);
-  free(e);
+  /* the sprites belong to the enemy's target skane */
+  obj_pool_free(ENEMY, enem);
 }
 
 static void
-updateCollisionEnemy(void* enem, vector* col_matrix)
+updateCollisionEnemy(void* enem, Broadphase_t* col_grid)
 {
   Enemy_t* e      = (Enemy_t*)enem;
   e->collided_ene = false; // reset collision with allies state
 
-  e->obj->vtable->updateCollision(e, col_matrix);
+  e->obj->vtable->updateCollision(e, col_grid);
 }
 
 const static Object_Vtable_t enemy_vtable = { .draw      = renderEnemy,
@@ -122,16 +106,13 @@ new_enemy(float x,
           unsigned attack_delay,
           Skane_t* ska)
 {
-  static size_t id = 1;
-  Enemy_t* enemy   = (Enemy_t*)malloc(sizeof(Enemy_t));
+  Enemy_t* enemy = (Enemy_t*)obj_pool_alloc(ENEMY);
   if (!enemy)
     return NULL;
 
-  Object_t* obj = new_object(0, 0, x, y, &ska->ska_sprt.ene_sprite[0]);
-  if (!obj) {
-    free(enemy);
-    return NULL;
-  }
+  /* the base object lives right after the enemy in the pooled block */
+  Object_t* obj = (Object_t*)(enemy + 1);
+  init_object(obj, 0, 0, x, y, &ska->ska_sprt.ene_sprite[0]);
 
   /* enemy basic stats */
   enemy->health       = health;
@@ -149,8 +130,11 @@ new_enemy(float x,
 
   /* identification */
   obj->identifier.type = ENEMY;
-  obj->identifier.id   = id;
-  ++id;
+  obj->identifier.id   = new_obj_id(enemy);
+  if (!obj->identifier.id) {
+    obj_pool_free(ENEMY, enemy);
+    return NULL;
+  }
   enemy->obj    = obj;
   enemy->vtable = &enemy_vtable;
   return enemy;
@@ -169,9 +153,51 @@ enemy_take_damage(Enemy_t* enemy, uint8_t damage)
     else
       warn("Could not spawn food from this enemy");
 
-    enemy->obj->identifier.id = 0;
+    kill_object(enemy->obj);
     return;
   }
 
   enemy->health -= damage;
 }
+
+void
+update_enemies(void** enemies, size_t n)
+{
+  for (size_t i = 0; i < n; ++i) {
+    Enemy_t* enemy = (Enemy_t*)enemies[i];
+    Object_t* obj  = enemy->obj;
+    Object_t* tgt  = enemy->ska->obj;
+
+    /* get movement direction */
+    if (!enemy->is_attacking) {
+      float cx = obj->x + obj->sprite.Width / 2;
+      float cy = obj->y + obj->sprite.Height / 2;
+      float tx = tgt->x + tgt->sprite.Width / 2;
+      float ty = tgt->y + tgt->sprite.Height / 2;
+
+      /* go around the walls that hide the target (if any) */
+      if (enemy->ska->flow) {
+        flow_field_target(enemy->ska->flow, tx, ty);
+        flow_field_waypoint(enemy->ska->flow, cx, cy, &tx, &ty);
+      }
+
+      float del_x = tx - cx;
+      float del_y = ty - cy;
+      if (del_x || del_y) {
+        float norm   = sqrt(del_x * del_x + del_y * del_y);
+        obj->speed_x = del_x / norm * enemy->speed;
+        obj->speed_y = del_y / norm * enemy->speed;
+
+        obj->x += obj->speed_x;
+        obj->y += obj->speed_y;
+      }
+    }
+
+    if (enemy->is_attacking)
+      --enemy->curr_attack;
+    if (enemy->curr_attack == 0)
+      enemy->is_attacking = false;
+
+    animate_enemy(enemy);
+  }
+}
@@ -13,8 +13,11 @@
 static void
 verr(FILE* fp, const char* fmt, va_list ap)
 {
+  va_list ap_copy; // a va_list can only be traversed once
+  va_copy(ap_copy, ap);
   vfprintf(stderr, fmt, ap);
-  vfprintf(fp, fmt, ap);
+  vfprintf(fp, fmt, ap_copy);
+  va_end(ap_copy);
 
   if (fmt[0] && fmt[strlen(fmt) - 1] == ':') {
     fputc(' ', stderr);
@@ -4,6 +4,7 @@
 #include <string.h>
 #include <time.h>
 
+#include "include/arena.h"
 #include "include/bmp.h"
 #include "include/err_utils.h"
 #include "include/ev_disp.h"
@@ -11,6 +12,7 @@
 #include "include/menu.h"
 #include "include/mouse.h"
 #include "include/obj_handle.h"
+#include "include/profiler.h"
 #include "include/rtc.h"
 #include "include/serial.h"
 #include "include/timer.h"
@@ -20,23 +22,104 @@
 static int hook_ids[]      = { 0, 0, 0, 0, 0 };
 static gamestate gamest    = MENUST;
 static uint16_t video_mode = DFLT_VIDEO_MODE;
+static bool fixed_seed     = false; /* seed rand() with rand_seed */
+static unsigned rand_seed  = 0;
+static bool headless       = false; /* simulate only (nothing is drawn) */
+static bool ram_buff       = false; /* draw to system memory (not VRAM) */
 char respath[PATH_MAXSIZE];
 
+/* fixed timestep: each timer tick owes SIM_HZ to the simulation and each step
+ * pays TICK_HZ (negative debts mean the simulation is ahead of the screen) */
+static int32_t sim_debt   = 0;
+static int32_t lost_ticks = 0;     /* RTC seconds minus timer ticks (in ticks) */
+static bool rtc_synced    = false; /* counting from a whole RTC second */
+static uint8_t sim_drops  = 0;     /* frames dropped in a row */
+
 // Nem toda a gente vive no teu retard :( . Tabém?¿?
 
 /* GAME LOCAL UTILITY FUNCTIONS */
 static inline void
-update(void)
+redraw(float lag)
 {
-  clear_collision_matrix();
-  update_objs_collisions();
-  calc_objs_pos();
-  render_objects();
+  PROF_SCOPE(PROF_RENDER, render_objects(lag));
   /* debug_collisions(); */ // TODO collision are delayed 1 frame (for skane)
 
-  next_buff();
-  if (garbage_collector()) // cull dead objects
-    exit_to_main_menu();   // a Skane died
+  PROF_SCOPE(PROF_FLIP, next_buff());
+}
+
+static inline void
+update(bool draw, float lag)
+{
+  bool ska_died;
+
+  PROF_BEGIN(PROF_UPDATE);
+  save_objs_pos(); // start of the step (to interpolate the drawing)
+  PROF_SCOPE(PROF_CLEAR, clear_collision_matrix());
+  PROF_SCOPE(PROF_COLLISIONS, update_objs_collisions());
+  PROF_SCOPE(PROF_POSITIONS, calc_objs_pos());
+  if (draw)
+    redraw(lag);
+
+  PROF_SCOPE(PROF_GC, ska_died = garbage_collector()); // cull dead objects
+  arena_reset(frame_arena()); // drop the scratch data of this frame
+  PROF_END(PROF_UPDATE);
+  PROF_END_FRAME();
+
+  if (ska_died)
+    exit_to_main_menu(); // a Skane died
+}
+
+/* FIXED TIMESTEP */
+static void
+sim_reset(void)
+{
+  sim_debt   = 0;
+  lost_ticks = 0;
+  rtc_synced = false;
+  sim_drops  = 0;
+}
+
+static void
+sim_second(void)
+{
+  /* a second went by (RTC update): the ticks that never came (the board
+   * couldn't keep up with the timer) are owed to the simulation */
+  if (!rtc_synced) {
+    rtc_synced = true;
+    lost_ticks = 0;
+    return;
+  }
+
+  lost_ticks += TICK_HZ;
+  if (lost_ticks > SIM_LAG_SLACK) {
+    sim_debt   += (lost_ticks - SIM_LAG_SLACK) * SIM_HZ;
+    lost_ticks = SIM_LAG_SLACK;
+  }
+  else if (lost_ticks < -SIM_LAG_SLACK)
+    lost_ticks = -SIM_LAG_SLACK; // the timer is a bit fast
+}
+
+static uint8_t
+sim_tick(bool* draw, float* lag)
+{
+  /* a tick went by: get the number of steps to simulate and if (and how) the
+   * frame is drawn */
+  if (rtc_synced)
+    --lost_ticks;
+
+  sim_debt += SIM_HZ;
+  uint8_t steps = 0;
+  for (; sim_debt > 0 && steps < SIM_MAX_STEPS; ++steps)
+    sim_debt -= TICK_HZ;
+
+  /* still behind: drop the frame (but not too many in a row, and never owe
+   * more than a second, so very slow boards slow down instead) */
+  *draw     = sim_debt <= 0 || sim_drops >= SIM_MAX_DROPS;
+  sim_drops = *draw ? 0 : sim_drops + 1;
+  if (sim_debt > SIM_HZ * TICK_HZ)
+    sim_debt = SIM_HZ * TICK_HZ;
+  *lag = sim_debt < 0 ? (float)-sim_debt / TICK_HZ : 0;
+  return steps;
 }
 
 /* GAME FUNCTIONS */
@@ -53,6 +136,25 @@ set_videomode(const uint16_t mode)
   video_mode = mode;
 }
 
+void
+set_seed(const unsigned seed)
+{
+  fixed_seed = true;
+  rand_seed  = seed;
+}
+
+void
+set_headless(void)
+{
+  headless = true;
+}
+
+void
+set_ram_buff(void)
+{
+  ram_buff = true;
+}
+
 /* COMMUNICATION HANDLING */
 static void
 reshake(void)
@@ -220,6 +322,7 @@ start_game(rtctime_t* curr_time)
 {
   alloc_obj_matrix();
   alloc_collison_matrix();
+  alloc_obj_pools();
   /* gameplay */
   inst_skane(gamest);
   create_map(gamest);
@@ -234,6 +337,11 @@ start_game(rtctime_t* curr_time)
 
   /* enemy spawn */
   rtc_set_alarm_ff_curr(curr_time, ENEMY_SPAWN_RATE);
+
+  /* the RTC seconds tell the ticks that were lost */
+  sim_reset();
+  if (rtc_enable_updateint())
+    warn("%s: The game will slow down if it can't keep up", __func__);
 }
 
 static inline void
@@ -294,6 +402,7 @@ exit_to_main_menu(void)
   clear_collision_matrix();
 
   rtc_disable_alrm();
+  rtc_disable_updateint();
   if (gamest == MULT1 || gamest == MULT2) {
     serial_restore_conf();
     if (unsubscribe_int(&hook_ids[4]))
@@ -309,6 +418,40 @@ exit_to_main_menu(void)
 }
 
 /* MAINLOOP */
+static void
+game_step(input_array_t input_array, bool draw, float lag)
+{
+  /* Handle missile fire */
+  if (input_array[lmb])
+    ska1_fire_missle();
+  /* move skane */
+  ska1_mov(input_array);
+
+  /* get info */
+  if (gamest == MULT1 || gamest == MULT2) {
+    /* get and parse info */
+    com_handler();
+    if (gamest == MENUST) // If com handler quit the game, exit
+      return;
+  }
+
+  /* call update method */
+  update(draw, lag);
+
+  /* transmit info */
+  if (gamest == MULT1 || gamest == MULT2) {
+    if (transmit_skane_info()) // queue end frame packet for sending (if
+                               // no info sent)
+      serial_send_push(HTCHECK + SERIAL_SYNC_PACK);
+    /* transmit */
+    serial_send_all();
+  }
+
+  /* Quit to main menu */
+  if (input_array[ESC])
+    exit_to_main_menu();
+}
+
 void
 mainloop(void)
 {
@@ -364,35 +507,15 @@ mainloop(void)
         timer_ih(); // timer interrupt handler
 
         if (gamest != MENUST) {
-          /* Handle missile fire */
-          if (input_array[lmb])
-            ska1_fire_missle();
-          /* move skane */
-          ska1_mov(input_array);
-
-          /* get info */
-          if (gamest == MULT1 || gamest == MULT2) {
-            /* get and parse info */
-            com_handler();
-            if (gamest == MENUST) // If com handler quit the game, exit
-              continue;
-          }
-
-          /* call update method */
-          update();
-
-          /* transmit info */
-          if (gamest == MULT1 || gamest == MULT2) {
-            if (transmit_skane_info()) // queue end frame packet for sending (if
-                                       // no info sent)
-              serial_send_push(HTCHECK + SERIAL_SYNC_PACK);
-            /* transmit */
-            serial_send_all();
-          }
-
-          /* Quit to main menu */
-          if (input_array[ESC])
-            exit_to_main_menu();
+          /* fixed timestep: the steps owed (only the last one is drawn) */
+          bool draw;
+          float lag;
+          uint8_t steps = sim_tick(&draw, &lag);
+          for (uint8_t i = 0; i < steps && gamest != MENUST; ++i)
+            game_step(input_array, draw && i + 1 == steps, lag);
+
+          if (!steps && draw && gamest != MENUST)
+            redraw(lag); // no step: only the interpolation moves
         }
         else {
           draw_menus();
@@ -404,10 +527,12 @@ mainloop(void)
         }
       }
       else if (msg.m_notify.interrupts & BIT(RTC_IRQ)) { // RTC
-        warn("fcking RTC");
         rtc_ih(); // RTC interrupt handler
         uint8_t curr_creg = rtc_get_creg();
 
+        if (gamest != MENUST && curr_creg & RTC_UF)
+          sim_second(); // count the ticks lost in the last second
+
         /* there can be multiple interrupts at the same time */
         if (gamest != MENUST && curr_creg & RTC_AF) {
           /* spawn enemy and handle cooldown */
@@ -453,13 +578,15 @@ init(void)
 {
   /* clear log file contents */
   clrlogs();
+  /* frame phases timing (only if built with PROFILE defined) */
+  PROF_INIT();
 
   /* set default resources path if none is set */
   if (strlen(respath) == 0)
     strcpy(respath, DFLT_RESPATH);
 
-  /* initialize random seed */
-  srand(time(NULL));
+  /* initialize random seed (fixed seeds make runs reproducible) */
+  srand(fixed_seed ? rand_seed : (unsigned)time(NULL));
 
   /* set alarm for enemy spawn */
   rtc_disable_alrm();
@@ -474,6 +601,9 @@ init(void)
   /* video mode stuff */
   if (!vginit(video_mode, true))
     die("%s: Couldn't initialize video mode", __func__);
+  vg_set_headless(headless);
+  if (ram_buff && vg_set_ram_buff(true))
+    warn("%s: Drawing to video memory", __func__);
 
   vg_clear_all(); // initialize all video buffers to 0
 
@@ -492,6 +622,7 @@ quit(void)
 {
   if (gamest != MENUST)
     destroy_all_objects();
+  arena_free(frame_arena());
 
   /* unsubscribe mouse interrupts */
   mouse_set_stream_mode();
@@ -0,0 +1,211 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "include/flow_field.h"
+
+/* PRIVATE */
+/* neighbours of a cell (E, NE, N, NW, W, SW, S, SE): the opposite of
+ * direction d is (d + 4) % 8 */
+static const int8_t direc_x[FLOW_NO_DIREC] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+static const int8_t direc_y[FLOW_NO_DIREC] = { 0, -1, -1, -1, 0, 1, 1, 1 };
+
+/* line of sight cache values */
+#define FLOW_SIGHT_UNKNOWN 0
+#define FLOW_SIGHT_CLEAR   1
+#define FLOW_SIGHT_HIDDEN  2
+
+static inline int32_t
+flow_field_cell(const Flow_Field_t* ff, float x, float y)
+{
+  if (x < 0 || y < 0 || x >= ff->h_res || y >= ff->v_res)
+    return -1;
+  return (int32_t)((size_t)y / ff->cell_size * ff->cols +
+                   (size_t)x / ff->cell_size);
+}
+
+static inline bool
+flow_field_blocked(const Flow_Field_t* ff, int x, int y)
+{
+  return ff->blocked[(size_t)y * ff->cols + x];
+}
+
+static void
+flow_field_compute(Flow_Field_t* ff)
+{
+  size_t ncells = (size_t)ff->cols * ff->rows;
+  for (size_t i = 0; i < ncells; ++i) {
+    ff->dist[i] = FLOW_UNREACHED;
+    ff->next[i] = FLOW_NO_DIREC;
+  }
+  memset(ff->sight, FLOW_SIGHT_UNKNOWN, ncells);
+
+  /* breadth first search from the target (even if its cell is blocked) */
+  size_t head = 0, tail = 0;
+  ff->dist[ff->target] = 0;
+  ff->queue[tail++]    = ff->target;
+  while (head < tail) {
+    uint32_t u = ff->queue[head++];
+    int ux = u % ff->cols, uy = u / ff->cols;
+
+    for (uint8_t d = 0; d < FLOW_NO_DIREC; ++d) {
+      int vx = ux + direc_x[d], vy = uy + direc_y[d];
+      if (vx < 0 || vy < 0 || vx >= ff->cols || vy >= ff->rows)
+        continue;
+      uint32_t v = (uint32_t)vy * ff->cols + vx;
+      if (ff->blocked[v] || ff->dist[v] != FLOW_UNREACHED)
+        continue;
+      /* diagonals can't cut the corners of blocked cells */
+      if (direc_x[d] && direc_y[d] &&
+          (flow_field_blocked(ff, vx, uy) || flow_field_blocked(ff, ux, vy)))
+        continue;
+
+      ff->dist[v]       = ff->dist[u] + 1;
+      ff->next[v]       = (d + 4) % FLOW_NO_DIREC; // back to u
+      ff->queue[tail++] = v;
+    }
+  }
+}
+
+/* checks if the segment between the centers of two cells only goes through
+ * free cells (besides the two cells themselves) */
+static bool
+flow_field_sees(const Flow_Field_t* ff, uint32_t from, uint32_t to)
+{
+  int x = from % ff->cols, y = from / ff->cols;
+  int x1 = to % ff->cols, y1 = to / ff->cols;
+  int dx = abs(x1 - x), dy = abs(y1 - y);
+  int sx = x < x1 ? 1 : -1, sy = y < y1 ? 1 : -1;
+  int err = dx - dy;
+
+  /* walk every cell the segment touches (supercover line) */
+  for (int n = dx + dy; n > 1; --n) {
+    if (err > 0) {
+      x += sx;
+      err -= 2 * dy;
+    }
+    else if (err < 0) {
+      y += sy;
+      err += 2 * dx;
+    }
+    else { // through a corner: both cells beside it have to be free
+      if (flow_field_blocked(ff, x + sx, y) ||
+          flow_field_blocked(ff, x, y + sy))
+        return false;
+      x += sx;
+      y += sy;
+      err += 2 * (dx - dy);
+      if (--n == 1)
+        break; // got to the last cell
+    }
+
+    if (flow_field_blocked(ff, x, y))
+      return false;
+  }
+
+  return true;
+}
+
+/* PUBLIC */
+Flow_Field_t*
+new_flow_field(uint16_t h_res, uint16_t v_res, uint16_t cell_size)
+{
+  if (!cell_size)
+    return NULL;
+
+  Flow_Field_t* ff = (Flow_Field_t*)malloc(sizeof(Flow_Field_t));
+  if (!ff)
+    return NULL;
+
+  ff->h_res     = h_res;
+  ff->v_res     = v_res;
+  ff->cell_size = cell_size;
+  ff->cols      = (h_res + cell_size - 1) / cell_size;
+  ff->rows      = (v_res + cell_size - 1) / cell_size;
+  ff->target    = -1;
+
+  size_t ncells = (size_t)ff->cols * ff->rows;
+  ff->blocked   = (uint8_t*)calloc(ncells, sizeof(uint8_t));
+  ff->dist      = (uint16_t*)malloc(ncells * sizeof(uint16_t));
+  ff->next      = (uint8_t*)malloc(ncells * sizeof(uint8_t));
+  ff->sight     = (uint8_t*)malloc(ncells * sizeof(uint8_t));
+  ff->queue     = (uint32_t*)malloc(ncells * sizeof(uint32_t));
+  if (!ff->blocked || !ff->dist || !ff->next || !ff->sight || !ff->queue) {
+    free_flow_field(ff);
+    return NULL;
+  }
+
+  return ff;
+}
+
+void
+free_flow_field(Flow_Field_t* ff)
+{
+  if (!ff)
+    return;
+
+  free(ff->blocked);
+  free(ff->dist);
+  free(ff->next);
+  free(ff->sight);
+  free(ff->queue);
+  free(ff);
+}
+
+void
+flow_field_block(Flow_Field_t* ff, float x, float y, float w, float h)
+{
+  float x1 = x + w, y1 = y + h;
+  if (w <= 0 || h <= 0 || x1 <= 0 || y1 <= 0 || x >= ff->h_res ||
+      y >= ff->v_res)
+    return; // nothing on screen
+
+  /* cells [c0, c1] x [r0, r1] */
+  size_t c0 = x > 0 ? (size_t)x / ff->cell_size : 0;
+  size_t r0 = y > 0 ? (size_t)y / ff->cell_size : 0;
+  size_t c1 =
+    x1 >= ff->h_res ? ff->cols - 1u : ((size_t)ceilf(x1) - 1) / ff->cell_size;
+  size_t r1 =
+    y1 >= ff->v_res ? ff->rows - 1u : ((size_t)ceilf(y1) - 1) / ff->cell_size;
+
+  for (size_t r = r0; r <= r1; ++r)
+    memset(ff->blocked + r * ff->cols + c0, 1, c1 - c0 + 1);
+  ff->target = -1; // recompute on the next target
+}
+
+void
+flow_field_target(Flow_Field_t* ff, float x, float y)
+{
+  int32_t cell = flow_field_cell(ff, x, y);
+  if (cell == ff->target)
+    return; // still on the same cell
+
+  ff->target = cell;
+  if (cell >= 0)
+    flow_field_compute(ff);
+}
+
+bool
+flow_field_waypoint(Flow_Field_t* ff, float x, float y, float* wx, float* wy)
+{
+  int32_t cell = flow_field_cell(ff, x, y);
+  if (cell < 0 || ff->target < 0 || cell == ff->target || ff->blocked[cell] ||
+      ff->next[cell] == FLOW_NO_DIREC)
+    return false;
+
+  /* nothing in the way: straight to the target */
+  if (ff->sight[cell] == FLOW_SIGHT_UNKNOWN) {
+    bool clear      = flow_field_sees(ff, cell, ff->target);
+    ff->sight[cell] = clear ? FLOW_SIGHT_CLEAR : FLOW_SIGHT_HIDDEN;
+  }
+  if (ff->sight[cell] == FLOW_SIGHT_CLEAR)
+    return false;
+
+  /* head to the center of the next cell */
+  uint8_t d = ff->next[cell];
+  int col   = cell % ff->cols + direc_x[d];
+  int row   = cell / ff->cols + direc_y[d];
+  *wx       = col * ff->cell_size + ff->cell_size / 2.0f;
+  *wy       = row * ff->cell_size + ff->cell_size / 2.0f;
+  return true;
+}
@@ -1,5 +1,6 @@
 #include "include/food.h"
 #include "include/err_utils.h"
+#include "include/obj_handle.h"
 
 /* VIRTUAL FUNCTIONS */
 static void
@@ -28,16 +29,15 @@ renderFood(void* food)
 static void
 destroyFood(void* food)
 {
-  Food_t* f = (Food_t*)food;
-  f->obj->vtable->destroy(f->obj);
-  free(f);
+  /* the sprite belongs to the skane whose enemy dropped the food */
+  obj_pool_free(FOOD, food);
 }
 
 static void
-updateCollisionFood(void* food, vector* col_matrix)
+updateCollisionFood(void* food, Broadphase_t* col_grid)
 {
   Food_t* f = (Food_t*)food;
-  f->obj->vtable->updateCollision(f, col_matrix);
+  f->obj->vtable->updateCollision(f, col_grid);
 }
 
 const static Object_Vtable_t food_vtable = { .draw      = renderFood,
@@ -51,25 +51,25 @@ const static Object_Vtable_t food_vtable = { .draw      = renderFood,
 Food_t*
 new_food(float x, float y, u_int16_t nourishment, Sprite_t* sprite)
 {
-  Food_t* food = malloc(sizeof(Food_t));
+  Food_t* food = (Food_t*)obj_pool_alloc(FOOD);
 
   if (!food)
     return NULL;
 
-  Object_t* obj = new_object(0, 0, x, y, sprite);
-  if (!obj) {
-    free(food);
-    return NULL;
-  }
+  /* the base object lives right after the food in the pooled block */
+  Object_t* obj = (Object_t*)(food + 1);
+  init_object(obj, 0, 0, x, y, sprite);
   food->obj = obj;
 
   food->nourishment = nourishment;
   food->vtable      = &food_vtable;
 
-  static size_t curr_id      = 1;
-  food->obj->identifier.id   = curr_id;
+  food->obj->identifier.id   = new_obj_id(food);
   food->obj->identifier.type = FOOD;
-  ++curr_id;
+  if (!food->obj->identifier.id) {
+    obj_pool_free(FOOD, food);
+    return NULL;
+  }
 
   return food;
 }
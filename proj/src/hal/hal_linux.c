@@ -0,0 +1,1373 @@
+#include <lcom/lcf.h>
+#include <lcom/timer.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <unistd.h>
+
+#include "include/i8042.h"
+#include "include/i8254.h"
+#include "include/rtc_def.h"
+#include "include/serial.h"
+#include "include/uart.h"
+#include "include/vg_def.h"
+#include "include/vg_utils.h"
+
+/* Linux backend of the hardware abstraction layer. Every device the game talks
+ * to is emulated in memory:
+ *  - a virtual clock (no real waiting) drives the i8254 timer 0 and the RTC;
+ *  - the VBE BIOS calls are answered from a table of modes and the frame
+ * buffer is a plain heap allocation;
+ *  - the KBC is fed from an input script (see hal_load_script());
+ *  - the UART is either a loopback or a pair of (named) pipes.
+ * driver_receive() delivers one interrupt per message, in PIC priority order,
+ * and advances the virtual clock to the next timer 0 tick when no other device
+ * has anything to say. */
+
+/** Ticks per second of the (virtual) system clock (sys_hz on MINIX) */
+#define HAL_HZ 60
+/** Size of the emulated low memory (first MiB) */
+#define LOW_MEM_SIZE BIT(20)
+/** First byte of low memory handed out by lm_alloc */
+#define LOW_MEM_BASE 0x10000
+/** Physical address of the emulated linear frame buffer */
+#define VRAM_PHYS 0xE0000000
+/** Total emulated video memory (in bytes) */
+#define VRAM_TOTAL (16 * MiB)
+/** Capacity of the KBC and UART fifos */
+#define HAL_FIFO_SIZE 4096
+/** Seconds after midnight at which the RTC starts counting (12:00:00) */
+#define RTC_START_SECS (12 * 3600)
+
+#define DEC2BCD_HAL(x) ((uint8_t)((((x) / 10) << 4) | ((x) % 10)))
+
+/* PRIVATE */
+/* FIFO */
+typedef struct
+{
+  uint16_t data[HAL_FIFO_SIZE];
+  size_t front, back;
+} hal_fifo_t;
+
+static bool
+fifo_empty(const hal_fifo_t* f)
+{
+  return f->front == f->back;
+}
+
+static void
+fifo_push(hal_fifo_t* f, uint16_t val)
+{
+  if (f->back - f->front == HAL_FIFO_SIZE) // full: drop the oldest value
+    ++f->front;
+  f->data[f->back++ % HAL_FIFO_SIZE] = val;
+}
+
+static uint16_t
+fifo_front(const hal_fifo_t* f)
+{
+  return f->data[f->front % HAL_FIFO_SIZE];
+}
+
+static uint16_t
+fifo_pop(hal_fifo_t* f)
+{
+  return f->data[f->front++ % HAL_FIFO_SIZE];
+}
+
+static void
+fifo_clear(hal_fifo_t* f)
+{
+  f->front = f->back = 0;
+}
+
+/* VIRTUAL CLOCK */
+static uint64_t vclock_us;      /* current virtual time */
+static uint64_t next_tick_us;   /* virtual time of the next timer 0 irq */
+static uint64_t timer0_period;  /* timer 0 irq period (in ns) */
+static uint64_t timer0_acc_ns;  /* sub-microsecond part of the tick times */
+static uint64_t frames;         /* number of timer 0 irqs delivered */
+static uint64_t max_frames;     /* stop after this many frames (0 if never) */
+static bool quit_requested;     /* the input script ended the run */
+static struct timespec wall_beg; /* real time at the start of the run */
+static struct timespec sim_beg;  /* real time of the first frame */
+
+/* IRQS */
+#define NUM_IRQS 16
+static int irq_hooks[NUM_IRQS]; /* hook (bit) of each subscribed irq line */
+static bool irq_subbed[NUM_IRQS];
+
+/* VIDEO */
+typedef struct
+{
+  uint16_t mode;
+  uint16_t h_res, v_res;
+  uint8_t bitspixel;
+  uint8_t memory_model;
+  uint8_t r_size, r_pos, g_size, g_pos, b_size, b_pos;
+} hal_mode_t;
+
+static const hal_mode_t vbe_modes[] = {
+  { 0x105, 1024, 768, 8, VBE_PACKED_PIXEL, 0, 0, 0, 0, 0, 0 },
+  { 0x107, 1280, 1024, 8, VBE_PACKED_PIXEL, 0, 0, 0, 0, 0, 0 },
+  { 0x110, 640, 480, 15, VBE_DIRECT_COLOR, 5, 10, 5, 5, 5, 0 },
+  { 0x115, 800, 600, 24, VBE_DIRECT_COLOR, 8, 16, 8, 8, 8, 0 },
+  { 0x11A, 1280, 1024, 16, VBE_DIRECT_COLOR, 5, 11, 6, 5, 5, 0 },
+  { 0x14C, 1152, 864, 32, VBE_DIRECT_COLOR, 8, 16, 8, 8, 8, 0 },
+};
+#define NUM_VBE_MODES (sizeof(vbe_modes) / sizeof(vbe_modes[0]))
+
+static const hal_mode_t* curr_mode; /* NULL in text mode */
+static uint8_t* vram;               /* emulated frame buffer */
+static size_t vram_len;             /* mapped size of the frame buffer */
+static uint32_t scanline_bytes;     /* logical scan line length */
+static uint16_t disp_x, disp_y;     /* display start */
+static uint8_t dac_bits = DFLT_DAC_BITS;
+static uint32_t palette[256];
+static const char* screenshot_path; /* dump the shown buffer here on exit */
+
+/* LOW MEMORY */
+static uint8_t low_mem[LOW_MEM_SIZE];
+static phys_bytes low_mem_top = LOW_MEM_BASE;
+static unsigned low_mem_live; /* number of lm_alloc'ed blocks not freed */
+
+/* KBC */
+#define KBC_SRC_MOUSE BIT(8) /* fifo values with this bit came from the mouse */
+static hal_fifo_t kbc_out;    /* bytes waiting in the output buffer */
+static uint8_t kbc_last_out;  /* last byte read from the output buffer */
+static uint8_t kbc_cmd_byte = KBC_CONF_INTEN | BIT(2) | BIT(6);
+static uint8_t kbc_expect;    /* what the next byte written to 0x60 is */
+static bool mouse_reporting;
+
+/* INPUT SCRIPT */
+typedef struct
+{
+  uint64_t frame;  /* frame at which the event happens */
+  uint8_t bytes[3];
+  uint8_t n_bytes; /* 0 for the quit event */
+  bool is_mouse;
+} hal_event_t;
+
+static hal_event_t* events;
+static size_t events_end, events_size, events_next;
+static hal_fifo_t dev_bytes; /* device bytes waiting to enter the KBC */
+
+/* TIMER */
+static uint8_t timer_ctrl[3] = { TIMER_LSB_MSB | TIMER_SQR_WAVE,
+                                 TIMER_LSB_MSB | TIMER_SQR_WAVE,
+                                 TIMER_LSB_MSB | TIMER_SQR_WAVE };
+static uint16_t timer_div[3] = { TIMER_FREQ / TIMER0_FREQ,
+                                 TIMER_FREQ / TIMER0_FREQ,
+                                 TIMER_FREQ / TIMER0_FREQ };
+static bool timer_st_latched[3];
+static bool timer_msb_next[3];
+
+/* RTC */
+static uint8_t rtc_sel;
+static uint8_t rtc_regb = BIT(1); /* 24h, BCD */
+static uint8_t rtc_regc;
+static uint8_t rtc_alarm[3]; /* seconds, minutes, hours (BCD) */
+static uint64_t rtc_last_sec;
+
+/* UART */
+static hal_fifo_t uart_rx;
+static uint8_t uart_ier = DFLT_IER, uart_lcr = DFLT_LCR, uart_mcr, uart_scr;
+static uint8_t uart_dll = DFLT_DLL, uart_dlm = DFLT_DLM;
+static bool uart_fifo_en;
+static bool uart_thre_pending;
+static int uart_in_fd = -1, uart_out_fd = -1; /* -1: loopback */
+
+static void
+hal_warn(const char* fmt, ...)
+{
+  va_list ap;
+  va_start(ap, fmt);
+  fprintf(stderr, "hal: ");
+  vfprintf(stderr, fmt, ap);
+  fputc('\n', stderr);
+  va_end(ap);
+}
+
+/* RTC */
+static uint64_t
+rtc_now_secs(void)
+{
+  return RTC_START_SECS + vclock_us / 1000000;
+}
+
+static bool
+rtc_alarm_field_matches(uint8_t alarm, uint8_t curr)
+{
+  return (alarm & RTC_IDC_VAL) == RTC_IDC_VAL || alarm == curr;
+}
+
+static void
+rtc_step(void)
+{
+  uint64_t now = rtc_now_secs();
+  for (; rtc_last_sec < now; ++rtc_last_sec) {
+    uint32_t day_secs = (rtc_last_sec + 1) % (24 * 3600);
+    uint8_t sec       = DEC2BCD_HAL(day_secs % 60);
+    uint8_t min       = DEC2BCD_HAL((day_secs / 60) % 60);
+    uint8_t hour      = DEC2BCD_HAL(day_secs / 3600);
+
+    if (rtc_regb & RTC_UIE)
+      rtc_regc |= RTC_UF | RTC_IRQF;
+    if ((rtc_regb & RTC_AIE) && rtc_alarm_field_matches(rtc_alarm[0], sec) &&
+        rtc_alarm_field_matches(rtc_alarm[1], min) &&
+        rtc_alarm_field_matches(rtc_alarm[2], hour))
+      rtc_regc |= RTC_AF | RTC_IRQF;
+  }
+}
+
+static uint8_t
+rtc_read(uint8_t reg)
+{
+  uint32_t day_secs = rtc_now_secs() % (24 * 3600);
+  uint8_t val;
+
+  switch (reg) {
+    case SEC_REG:
+      return DEC2BCD_HAL(day_secs % 60);
+    case MIN_REG:
+      return DEC2BCD_HAL((day_secs / 60) % 60);
+    case HOUR_REG:
+      return DEC2BCD_HAL(day_secs / 3600);
+    case ASEC_REG:
+      return rtc_alarm[0];
+    case AMIN_REG:
+      return rtc_alarm[1];
+    case AHOUR_REG:
+      return rtc_alarm[2];
+    case DOW_REG:
+      return 0x04; // wednesday
+    case DOM_REG:
+      return 0x01; // 1st
+    case MONTH_REG:
+      return 0x01; // january
+    case YEAR_REG:
+      return 0x20; // 2020
+    case RTC_AREG:
+      return 0x26; // 32.768 kHz, 1024 Hz, no update in progress
+    case RTC_BREG:
+      return rtc_regb;
+    case RTC_CREG:
+      val      = rtc_regc;
+      rtc_regc = 0; // reading C acknowledges the interrupt
+      return val;
+    case RTC_DREG:
+      return RTC_VRT;
+    default:
+      return 0;
+  }
+}
+
+static void
+rtc_write(uint8_t reg, uint8_t val)
+{
+  switch (reg) {
+    case ASEC_REG:
+      rtc_alarm[0] = val;
+      break;
+    case AMIN_REG:
+      rtc_alarm[1] = val;
+      break;
+    case AHOUR_REG:
+      rtc_alarm[2] = val;
+      break;
+    case RTC_BREG:
+      rtc_regb = val;
+      break;
+    default:
+      break; // the time itself follows the virtual clock
+  }
+}
+
+/* VIRTUAL CLOCK */
+static void
+clock_advance_us(uint64_t us)
+{
+  vclock_us += us;
+  rtc_step();
+
+  /* timer 0 irqs that would have been raised meanwhile are coalesced */
+  while (next_tick_us <= vclock_us) {
+    timer0_acc_ns += timer0_period;
+    next_tick_us += timer0_acc_ns / 1000;
+    timer0_acc_ns %= 1000;
+  }
+}
+
+static void
+timer0_update_period(void)
+{
+  /* period of the irqs given by the counter's divisor (0 means 65536) */
+  uint32_t div  = timer_div[0] ? timer_div[0] : 65536;
+  timer0_period = (uint64_t)div * 1000000000 / TIMER_FREQ;
+}
+
+/* UART */
+static void
+uart_poll_pipe(void)
+{
+  if (uart_in_fd < 0)
+    return;
+
+  uint8_t buf[256];
+  ssize_t n;
+  while ((n = read(uart_in_fd, buf, sizeof(buf))) > 0) {
+    for (ssize_t i = 0; i < n; ++i)
+      fifo_push(&uart_rx, buf[i]);
+  }
+}
+
+static void
+uart_transmit(uint8_t data)
+{
+  if (uart_out_fd < 0) {
+    fifo_push(&uart_rx, data); // loopback
+  }
+  else if (write(uart_out_fd, &data, 1) != 1) {
+    hal_warn("serial pipe write failed: %s", strerror(errno));
+  }
+  uart_thre_pending = true;
+}
+
+static uint8_t
+uart_iir(bool acknowledge)
+{
+  uint8_t fifo_bits = uart_fifo_en ? IIR_ISBOTHFIFO : 0;
+
+  if ((uart_ier & IER_DATAINT) && !fifo_empty(&uart_rx))
+    return IIR_RCVRDATA | fifo_bits;
+  if ((uart_ier & IER_TRAHOLDINT) && uart_thre_pending) {
+    if (acknowledge)
+      uart_thre_pending = false; // reading IIR clears the THRE interrupt
+    return IIR_TRANSHOLD | fifo_bits;
+  }
+
+  return IIR_NOINT | fifo_bits;
+}
+
+static bool
+uart_read(int off, uint8_t* val)
+{
+  bool dlab = uart_lcr & LCR_DIVLATCHACCESS;
+
+  uart_poll_pipe();
+  switch (off) {
+    case UART_RBR:
+      *val = dlab ? uart_dll
+                  : (fifo_empty(&uart_rx) ? 0 : (uint8_t)fifo_pop(&uart_rx));
+      return true;
+    case UART_IER:
+      *val = dlab ? uart_dlm : uart_ier;
+      return true;
+    case UART_IIR:
+      *val = uart_iir(true);
+      return true;
+    case UART_LCR:
+      *val = uart_lcr;
+      return true;
+    case UART_MCR:
+      *val = uart_mcr;
+      return true;
+    case UART_LSR:
+      *val = LSR_TRAHOLD | LSR_EMPTYREG |
+             (fifo_empty(&uart_rx) ? 0 : LSR_DATA);
+      return true;
+    case UART_MSR:
+      *val = BIT(7) | BIT(5) | BIT(4); // DCD DSR CTS
+      return true;
+    case UART_SR:
+      *val = uart_scr;
+      return true;
+    default:
+      return false;
+  }
+}
+
+static bool
+uart_write(int off, uint8_t val)
+{
+  bool dlab = uart_lcr & LCR_DIVLATCHACCESS;
+
+  switch (off) {
+    case UART_THR:
+      if (dlab)
+        uart_dll = val;
+      else
+        uart_transmit(val);
+      return true;
+    case UART_IER:
+      if (dlab)
+        uart_dlm = val;
+      else {
+        /* enabling the THRE interrupt with an empty THR raises it */
+        if (!(uart_ier & IER_TRAHOLDINT) && (val & IER_TRAHOLDINT))
+          uart_thre_pending = true;
+        uart_ier = val & 0x0F;
+      }
+      return true;
+    case UART_FCR:
+      uart_fifo_en = val & FCR_BOTHFIFO;
+      if (val & FCR_CLRRCVR)
+        fifo_clear(&uart_rx);
+      return true;
+    case UART_LCR:
+      uart_lcr = val;
+      return true;
+    case UART_MCR:
+      uart_mcr = val;
+      return true;
+    case UART_SR:
+      uart_scr = val;
+      return true;
+    default:
+      return false;
+  }
+}
+
+/* KBC */
+static void
+kbc_push_out(uint8_t byte, bool is_mouse)
+{
+  fifo_push(&kbc_out, byte | (is_mouse ? KBC_SRC_MOUSE : 0));
+}
+
+static void
+mouse_command(uint8_t cmd)
+{
+  switch (cmd) {
+    case MOU_ENABLE_DATA_REPORT_CMD:
+      mouse_reporting = true;
+      break;
+    case MOU_DISABLE_DATA_REPORT_CMD:
+      mouse_reporting = false;
+      break;
+    case MOU_SET_STREAM_MODE_CMD:
+    case MOU_SET_REMOTE_MODE_CMD:
+      mouse_reporting = false;
+      break;
+    default:
+      break;
+  }
+  kbc_push_out(MOU_CMD_ACK, true);
+}
+
+static void
+kbc_write_cmd_port(uint8_t cmd)
+{
+  switch (cmd) {
+    case KBC_READ_CMD:
+      kbc_push_out(kbc_cmd_byte, false);
+      break;
+    case KBC_WRITE_CMD:
+    case KBC_MOUSE_CMD:
+      kbc_expect = cmd;
+      break;
+    case KBD_DISABLE_CMD:
+      kbc_cmd_byte |= KBC_CONF_KBDDIS;
+      break;
+    case KBD_ENABLE_CMD:
+      kbc_cmd_byte &= ~KBC_CONF_KBDDIS;
+      break;
+    case 0xA7:
+      kbc_cmd_byte |= KBC_CONF_MOUDIS; // disable mouse
+      break;
+    case 0xA8:
+      kbc_cmd_byte &= ~KBC_CONF_MOUDIS; // enable mouse
+      break;
+    default:
+      break;
+  }
+}
+
+static void
+kbc_write_data_port(uint8_t data)
+{
+  switch (kbc_expect) {
+    case KBC_WRITE_CMD:
+      kbc_cmd_byte = data;
+      break;
+    case KBC_MOUSE_CMD:
+      mouse_command(data);
+      break;
+    default:
+      kbc_push_out(MOU_CMD_ACK, false); // keyboard ACKs with 0xFA
+      break;
+  }
+  kbc_expect = 0;
+}
+
+static uint8_t
+kbc_status(void)
+{
+  if (fifo_empty(&kbc_out))
+    return BIT(2); // system flag
+
+  return BIT(2) | KBC_STATUS_OBF |
+         ((fifo_front(&kbc_out) & KBC_SRC_MOUSE) ? KBC_STATUS_MDAT : 0);
+}
+
+/* INPUT SCRIPT */
+static void
+script_feed(void)
+{
+  /* queue the bytes of every event that is due */
+  while (events_next < events_end && events[events_next].frame <= frames) {
+    hal_event_t* ev = &events[events_next++];
+    if (!ev->n_bytes) { // quit
+      quit_requested = true;
+      return;
+    }
+    if (ev->is_mouse && !mouse_reporting)
+      continue; // the mouse doesn't send packets with data reporting off
+
+    for (uint8_t i = 0; i < ev->n_bytes; ++i)
+      fifo_push(&dev_bytes, ev->bytes[i] | (ev->is_mouse ? KBC_SRC_MOUSE : 0));
+  }
+
+  /* one byte at a time goes into the KBC's output buffer */
+  if (fifo_empty(&kbc_out) && !fifo_empty(&dev_bytes))
+    fifo_push(&kbc_out, fifo_pop(&dev_bytes));
+}
+
+static int
+script_add(const hal_event_t* ev)
+{
+  if (events_end == events_size) {
+    size_t new_size     = events_size ? events_size * 2 : 64;
+    hal_event_t* new_ev = realloc(events, new_size * sizeof(hal_event_t));
+    if (!new_ev)
+      return 1;
+    events      = new_ev;
+    events_size = new_size;
+  }
+
+  events[events_end++] = *ev;
+  return 0;
+}
+
+static int
+script_parse_line(char* line, hal_event_t* ev)
+{
+  char cmd[16], arg[16];
+  unsigned long long frame;
+  long code;
+  int dx, dy;
+
+  memset(ev, 0, sizeof(hal_event_t));
+  int n = sscanf(line, "%llu %15s", &frame, cmd);
+  if (n != 2)
+    return 1;
+  ev->frame = frame;
+
+  if (!strcmp(cmd, "press") || !strcmp(cmd, "release")) {
+    if (sscanf(line, "%*u %*s %li", &code) != 1 || code <= 0 || code > 0xFFFF)
+      return 1;
+    if (code > 0xFF)
+      ev->bytes[ev->n_bytes++] = code >> 8; // 2 byte scancode prefix
+    ev->bytes[ev->n_bytes++] = code & 0xFF;
+    if (cmd[0] == 'r')
+      ev->bytes[ev->n_bytes - 1] |= BREAKCODE;
+  }
+  else if (!strcmp(cmd, "mouse")) {
+    arg[0] = '\0';
+    if (sscanf(line, "%*u %*s %d %d %15s", &dx, &dy, arg) < 2 || dx < -256 ||
+        dx > 255 || dy < -256 || dy > 255)
+      return 1;
+
+    ev->is_mouse = true;
+    ev->n_bytes  = 3;
+    ev->bytes[0] = MOU_1ST_PACKET_BIT | (dx < 0 ? MOU_MSB_X_DELTA : 0) |
+                   (dy < 0 ? MOU_MSB_Y_DELTA : 0);
+    ev->bytes[0] |= strchr(arg, 'l') ? MOU_LB : 0;
+    ev->bytes[0] |= strchr(arg, 'r') ? MOU_RB : 0;
+    ev->bytes[0] |= strchr(arg, 'm') ? MOU_MB : 0;
+    ev->bytes[1] = dx & 0xFF;
+    ev->bytes[2] = dy & 0xFF;
+  }
+  else if (strcmp(cmd, "quit"))
+    return 1;
+
+  return 0;
+}
+
+/* Input script format (one event per line, '#' starts a comment):
+ *    <frame> press <scancode>      - make code (e.g. 0x11, 0xE048)
+ *    <frame> release <scancode>    - break code of the given make code
+ *    <frame> mouse <dx> <dy> [lrm] - mouse packet (with the buttons held)
+ *    <frame> quit                  - end the run
+ * Frames count timer 0 interrupts, so events happen at the same point of the
+ * game on every run. Events must be sorted by frame. */
+static int
+hal_load_script(const char* path)
+{
+  FILE* fp = fopen(path, "r");
+  if (!fp) {
+    hal_warn("couldn't open the input script %s: %s", path, strerror(errno));
+    return 1;
+  }
+
+  char line[256];
+  unsigned line_no = 0;
+  uint64_t last_frame = 0;
+  hal_event_t ev;
+  while (fgets(line, sizeof(line), fp)) {
+    ++line_no;
+    char* comment = strchr(line, '#');
+    if (comment)
+      *comment = '\0';
+    if (strspn(line, " \t\r\n") == strlen(line))
+      continue;
+
+    if (script_parse_line(line, &ev) || ev.frame < last_frame) {
+      hal_warn("%s:%u: invalid event", path, line_no);
+      fclose(fp);
+      return 1;
+    }
+    if (script_add(&ev)) {
+      hal_warn("not enough memory for the input script");
+      fclose(fp);
+      return 1;
+    }
+    last_frame = ev.frame;
+  }
+
+  fclose(fp);
+  return 0;
+}
+
+/* VBE */
+static const hal_mode_t*
+find_mode(uint16_t mode)
+{
+  for (size_t i = 0; i < NUM_VBE_MODES; ++i) {
+    if (vbe_modes[i].mode == mode)
+      return &vbe_modes[i];
+  }
+  return NULL;
+}
+
+static uint8_t
+mode_bytespixel(const hal_mode_t* m)
+{
+  return (m->bitspixel + 7) >> 3;
+}
+
+static void*
+low_mem_ptr(uint16_t seg, uint16_t off, size_t len)
+{
+  phys_bytes phys = ((phys_bytes)seg << 4) + off;
+  if (phys + len > LOW_MEM_SIZE)
+    return NULL;
+  return low_mem + phys;
+}
+
+static bool
+bios_vbe_ctrl_info(reg86_t* r)
+{
+  VbeInfoBlock_t* info = low_mem_ptr(r->es, r->di, sizeof(VbeInfoBlock_t));
+  if (!info)
+    return false;
+
+  /* strings and mode list live in the OEM data area, as with VBE 2.0 */
+  phys_bytes oem_phys = ((phys_bytes)r->es << 4) + r->di +
+                        offsetof(VbeInfoBlock_t, OemData);
+  static const char oem[] = "LCOM host HAL";
+  uint16_t* modes         = (uint16_t*)(info->OemData + sizeof(oem));
+
+  memset(info, 0, sizeof(VbeInfoBlock_t));
+  memcpy(info->VbeSignature, VESASIGN, 4);
+  info->VbeVersion  = 0x0200;
+  info->TotalMemory = VRAM_TOTAL / (GPUPAGESIZE * 1024);
+  memcpy(info->OemData, oem, sizeof(oem));
+  for (size_t i = 0; i < NUM_VBE_MODES; ++i)
+    modes[i] = vbe_modes[i].mode;
+  modes[NUM_VBE_MODES] = 0xFFFF;
+
+  /* far pointers (segment:offset) */
+  info->OemStringPtr     = (PB2BASE(oem_phys) << 16) | PB2OFF(oem_phys);
+  info->OemVendorNamePtr = info->OemStringPtr;
+  info->OemProductNamePtr = info->OemStringPtr;
+  info->OemProductRevPtr  = info->OemStringPtr;
+  oem_phys += sizeof(oem);
+  info->VideoModePtr = (PB2BASE(oem_phys) << 16) | PB2OFF(oem_phys);
+
+  return true;
+}
+
+static bool
+bios_vbe_mode_info(reg86_t* r)
+{
+  const hal_mode_t* m   = find_mode(r->cx);
+  vbe_mode_info_t* info = low_mem_ptr(r->es, r->di, sizeof(vbe_mode_info_t));
+  if (!m || !info)
+    return false;
+
+  memset(info, 0, sizeof(vbe_mode_info_t));
+  info->ModeAttributes   = BIT(0) | BIT(1) | BIT(3) | BIT(4) | BIT(7);
+  info->BytesPerScanLine = m->h_res * mode_bytespixel(m);
+  info->XResolution      = m->h_res;
+  info->YResolution      = m->v_res;
+  info->NumberOfPlanes   = 1;
+  info->BitsPerPixel     = m->bitspixel;
+  info->MemoryModel      = m->memory_model;
+  info->NumberOfImagePages = 1;
+  info->RedMaskSize        = m->r_size;
+  info->RedFieldPosition   = m->r_pos;
+  info->GreenMaskSize      = m->g_size;
+  info->GreenFieldPosition = m->g_pos;
+  info->BlueMaskSize       = m->b_size;
+  info->BlueFieldPosition  = m->b_pos;
+  info->PhysBasePtr        = VRAM_PHYS;
+  info->LinBytesPerScanLine = info->BytesPerScanLine;
+
+  return true;
+}
+
+static bool
+bios_vbe_set_mode(reg86_t* r)
+{
+  const hal_mode_t* m = find_mode(r->bx & ~VBE_SET_LIN_FRMBUF & 0x7FFF);
+  if (!m)
+    return false;
+
+  curr_mode      = m;
+  scanline_bytes = m->h_res * mode_bytespixel(m);
+  disp_x = disp_y = 0;
+  dac_bits        = DFLT_DAC_BITS;
+  return true;
+}
+
+static bool
+bios_vbe_scanline(reg86_t* r)
+{
+  if (!curr_mode)
+    return false;
+
+  uint8_t bpp = mode_bytespixel(curr_mode);
+  switch (r->bl) {
+    case VBE_SET_SCAN_PIX_OP:
+      scanline_bytes = r->cx * bpp;
+      break;
+    case VBE_GET_SCAN_INFO_OP:
+      break;
+    case 0x02:
+      scanline_bytes = r->cx; // set in bytes
+      break;
+    default:
+      return false;
+  }
+
+  r->bx = scanline_bytes;
+  r->cx = scanline_bytes / bpp;
+  r->dx = VRAM_TOTAL / scanline_bytes > 0xFFFF ? 0xFFFF
+                                               : VRAM_TOTAL / scanline_bytes;
+  return true;
+}
+
+static bool
+bios_vbe_display_start(reg86_t* r)
+{
+  switch (r->bl) {
+    case VBE_SET_START_OP:
+    case VBE_SET_START_OP_VSYNC:
+      disp_x = r->cx;
+      disp_y = r->dx;
+      return true;
+    case VBE_GET_START_OP:
+      r->bh = 0;
+      r->cx = disp_x;
+      r->dx = disp_y;
+      return true;
+    default:
+      return false;
+  }
+}
+
+static bool
+bios_vbe_dac(reg86_t* r)
+{
+  switch (r->bl) {
+    case VBE_SET_DAC_OP:
+      if (r->bh == TRUE_COLOR_BITS || r->bh == DFLT_DAC_BITS)
+        dac_bits = r->bh;
+      r->bh = dac_bits;
+      return true;
+    case VBE_GET_DAC_OP:
+      r->bh = dac_bits;
+      return true;
+    default:
+      return false;
+  }
+}
+
+static bool
+bios_vbe_palette(reg86_t* r)
+{
+  if (r->dx + r->cx > 256)
+    return false;
+  uint32_t* buf = low_mem_ptr(r->es, r->di, r->cx * sizeof(uint32_t));
+  if (!buf)
+    return false;
+
+  switch (r->bl) {
+    case VBE_SET_PALT_OP:
+    case VBE_SET_PALT_OP_VSYNC:
+      memcpy(palette + r->dx, buf, r->cx * sizeof(uint32_t));
+      return true;
+    case VBE_GET_PALT_OP:
+      memcpy(buf, palette + r->dx, r->cx * sizeof(uint32_t));
+      return true;
+    default:
+      return false;
+  }
+}
+
+/* SCREENSHOT */
+static uint8_t
+scale_channel(uint32_t val, uint8_t bits)
+{
+  return bits ? (val & ((1u << bits) - 1)) * 255 / ((1u << bits) - 1) : 0;
+}
+
+static void
+save_screenshot(void)
+{
+  if (!screenshot_path || !curr_mode || !vram)
+    return;
+
+  FILE* fp = fopen(screenshot_path, "wb");
+  if (!fp) {
+    hal_warn("couldn't open %s: %s", screenshot_path, strerror(errno));
+    return;
+  }
+
+  const hal_mode_t* m = curr_mode;
+  uint8_t bpp         = mode_bytespixel(m);
+  fprintf(fp, "P6\n%u %u\n255\n", m->h_res, m->v_res);
+  for (uint32_t y = 0; y < m->v_res; ++y) {
+    for (uint32_t x = 0; x < m->h_res; ++x) {
+      size_t off = (size_t)(disp_y + y) * scanline_bytes + (disp_x + x) * bpp;
+      uint32_t pix = 0;
+      if (off + bpp <= vram_len)
+        memcpy(&pix, vram + off, bpp); // little endian, like the real VRAM
+
+      uint8_t rgb[3];
+      if (m->memory_model == VBE_PACKED_PIXEL) {
+        uint32_t c = palette[pix & 0xFF];
+        rgb[0]     = scale_channel(c >> 16, dac_bits);
+        rgb[1]     = scale_channel(c >> 8, dac_bits);
+        rgb[2]     = scale_channel(c, dac_bits);
+      }
+      else {
+        rgb[0] = scale_channel(pix >> m->r_pos, m->r_size);
+        rgb[1] = scale_channel(pix >> m->g_pos, m->g_size);
+        rgb[2] = scale_channel(pix >> m->b_pos, m->b_size);
+      }
+      fwrite(rgb, 1, sizeof(rgb), fp);
+    }
+  }
+
+  fclose(fp);
+}
+
+static double
+elapsed_since(const struct timespec* beg)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - beg->tv_sec) + (now.tv_nsec - beg->tv_nsec) / 1e9;
+}
+
+static void
+hal_end_run(void)
+{
+  /* throughput only counts the frames (not the loading before them) */
+  double sim = frames ? elapsed_since(&sim_beg) : 0;
+  hal_warn("%" PRIu64 " frames, %.3f s virtual, %.3f s real (%.1f frames/s)",
+           frames,
+           vclock_us / 1e6,
+           elapsed_since(&wall_beg),
+           sim > 0 ? frames / sim : 0);
+  exit(EXIT_SUCCESS);
+}
+
+static void
+hal_release(void)
+{
+  save_screenshot();
+
+  free(vram);
+  vram = NULL;
+  free(events);
+  events = NULL;
+  if (uart_in_fd >= 0)
+    close(uart_in_fd);
+  if (uart_out_fd >= 0 && uart_out_fd != uart_in_fd)
+    close(uart_out_fd);
+  uart_in_fd = uart_out_fd = -1;
+}
+
+static int
+open_pipe(const char* path, int flags)
+{
+  /* O_RDWR so opening a FIFO doesn't block waiting for the other end */
+  int fd = open(path, O_RDWR | O_NONBLOCK | flags, 0600);
+  if (fd < 0)
+    hal_warn("couldn't open %s: %s", path, strerror(errno));
+  return fd;
+}
+
+static void
+print_usage(const char* prog)
+{
+  fprintf(stderr,
+          "Usage: %s [--input <script>] [--frames <n>] [--screenshot <ppm>]\n"
+          "       [--serial-in <pipe> --serial-out <pipe>] [--] <game args>\n",
+          prog);
+}
+
+/* PUBLIC */
+/* KERNEL CALLS */
+int
+sys_inb(int port, uint32_t* value)
+{
+  if (!value)
+    return EINVAL;
+
+  uint8_t byte = 0;
+  switch (port) {
+    case KBC_IO_BUF:
+      if (!fifo_empty(&kbc_out))
+        kbc_last_out = fifo_pop(&kbc_out);
+      byte = kbc_last_out;
+      break;
+    case KBC_ST_PORT:
+      byte = kbc_status();
+      break;
+    case TIMER_0:
+    case TIMER_1:
+    case TIMER_2:
+      if (timer_st_latched[port - TIMER_0]) {
+        timer_st_latched[port - TIMER_0] = false;
+        byte = timer_ctrl[port - TIMER_0] & 0x3F;
+      }
+      else // counter value: a rough position inside the current period
+        byte = (next_tick_us - vclock_us) & 0xFF;
+      break;
+    case RTC_IOB:
+      byte = rtc_read(rtc_sel);
+      break;
+    default:
+      if (port >= COM1_BASEADDR && port < COM1_BASEADDR + 8 &&
+          uart_read(port - COM1_BASEADDR, &byte))
+        break;
+      hal_warn("sys_inb: unemulated port 0x%X", port);
+      return EINVAL;
+  }
+
+  *value = byte;
+  return OK;
+}
+
+int
+sys_outb(int port, uint32_t value)
+{
+  uint8_t byte = value & 0xFF;
+  int t;
+
+  switch (port) {
+    case KBC_CMD_PORT:
+      kbc_write_cmd_port(byte);
+      break;
+    case KBC_IO_BUF:
+      kbc_write_data_port(byte);
+      break;
+    case TIMER_CTRL:
+      if ((byte & TIMER_RB_CMD) == TIMER_RB_CMD) { // read-back
+        for (t = 0; t < 3; ++t) {
+          if ((byte & TIMER_RB_SEL(t)) && !(byte & TIMER_RB_STATUS))
+            timer_st_latched[t] = true;
+        }
+      }
+      else if (byte & TIMER_INIT_MASK) {
+        t                 = byte >> 6;
+        timer_ctrl[t]     = byte & 0x3F;
+        timer_msb_next[t] = false;
+      }
+      break;
+    case TIMER_0:
+    case TIMER_1:
+    case TIMER_2:
+      t = port - TIMER_0;
+      switch (timer_ctrl[t] & TIMER_INIT_MASK) {
+        case TIMER_LSB:
+          timer_div[t] = byte;
+          break;
+        case TIMER_MSB:
+          timer_div[t] = byte << 8;
+          break;
+        default:
+          if (timer_msb_next[t])
+            timer_div[t] = (timer_div[t] & 0xFF) | (byte << 8);
+          else
+            timer_div[t] = byte;
+          timer_msb_next[t] = !timer_msb_next[t];
+          break;
+      }
+      if (t == 0)
+        timer0_update_period();
+      break;
+    case RTC_REGB:
+      rtc_sel = byte & 0x7F;
+      break;
+    case RTC_IOB:
+      rtc_write(rtc_sel, byte);
+      break;
+    default:
+      if (port >= COM1_BASEADDR && port < COM1_BASEADDR + 8 &&
+          uart_write(port - COM1_BASEADDR, byte))
+        break;
+      hal_warn("sys_outb: unemulated port 0x%X", port);
+      return EINVAL;
+  }
+
+  return OK;
+}
+
+int
+sys_irqsetpolicy(int irq_vec, int policy, int* hook_id)
+{
+  if (irq_vec < 0 || irq_vec >= NUM_IRQS || !hook_id || *hook_id < 0 ||
+      *hook_id >= 32)
+    return EINVAL;
+
+  irq_hooks[irq_vec]  = *hook_id;
+  irq_subbed[irq_vec] = true;
+  return OK;
+}
+
+int
+sys_irqrmpolicy(int* hook_id)
+{
+  if (!hook_id)
+    return EINVAL;
+
+  for (int i = 0; i < NUM_IRQS; ++i) {
+    if (irq_subbed[i] && irq_hooks[i] == *hook_id) {
+      irq_subbed[i] = false;
+      return OK;
+    }
+  }
+  return EINVAL;
+}
+
+int
+sys_privctl(int proc_ep, int req, void* p)
+{
+  return OK;
+}
+
+int
+sys_int86(reg86_t* reg86p)
+{
+  if (!reg86p || reg86p->intno != GPUINTNO)
+    return EINVAL;
+
+  if (reg86p->ah == 0x00) { // set text mode (what vg_exit does)
+    save_screenshot();         // last frame shown before leaving graphics
+    curr_mode = NULL;
+    return OK;
+  }
+  if (reg86p->ah != VBE_FUNCTION) {
+    reg86p->al = 0;
+    return OK;
+  }
+
+  bool success;
+  switch (reg86p->al) {
+    case VBE_GET_CTRL_FUNC:
+      success = bios_vbe_ctrl_info(reg86p);
+      break;
+    case VBE_GET_MODE_FUNC:
+      success = bios_vbe_mode_info(reg86p);
+      break;
+    case VBE_SET_MODE_FUNC:
+      success = bios_vbe_set_mode(reg86p);
+      break;
+    case VBE_SCANLINE_FUNC:
+      success = bios_vbe_scanline(reg86p);
+      break;
+    case VBE_DISP_START_FUNC:
+      success = bios_vbe_display_start(reg86p);
+      break;
+    case VBE_DAC_FUNC:
+      success = bios_vbe_dac(reg86p);
+      break;
+    case VBE_PALETTE_FUNC:
+      success = bios_vbe_palette(reg86p);
+      break;
+    default:
+      reg86p->ah = VBE_FNOTSUP;
+      reg86p->al = VBE_FSUP;
+      return OK;
+  }
+
+  reg86p->ah = success ? VBE_OK : VBE_FFAIL;
+  reg86p->al = VBE_FSUP;
+  return OK;
+}
+
+void*
+vm_map_phys(int who, void* phaddr, size_t len)
+{
+  if ((uintptr_t)phaddr != VRAM_PHYS || len > VRAM_TOTAL)
+    return MAP_FAILED;
+
+  free(vram);
+  if (!(vram = calloc(len, 1)))
+    return MAP_FAILED;
+  vram_len = len;
+
+  return vram;
+}
+
+int
+driver_receive(int src, message* m_ptr, int* status_ptr)
+{
+  if (!m_ptr || !status_ptr)
+    return EINVAL;
+
+  memset(m_ptr, 0, sizeof(message));
+  m_ptr->m_source = HARDWARE;
+  m_ptr->m_type   = NOTIFY_MESSAGE;
+  *status_ptr     = NOTIFY_MESSAGE;
+
+  while (true) {
+    uart_poll_pipe();
+    script_feed();
+    if (quit_requested || (max_frames && frames >= max_frames))
+      hal_end_run();
+
+    /* devices with something to say (in PIC priority order) */
+    bool pending[NUM_IRQS] = { false };
+    if (!fifo_empty(&kbc_out)) {
+      bool is_mouse = fifo_front(&kbc_out) & KBC_SRC_MOUSE;
+      if (is_mouse && (kbc_cmd_byte & KBC_CONF_MOUINT))
+        pending[MOU_IRQ] = true;
+      else if (!is_mouse && (kbc_cmd_byte & KBC_CONF_KBDINT))
+        pending[KBD_IRQ] = true;
+    }
+    pending[RTC_IRQ]  = rtc_regc & RTC_IRQF;
+    pending[COM1_IRQ] = !(uart_iir(false) & IIR_NOINT);
+
+    static const int priority[] = { 1, 8, 9, 10, 11, 12, 13, 14, 15,
+                                    3, 4, 5,  6,  7 };
+    for (size_t i = 0; i < sizeof(priority) / sizeof(priority[0]); ++i) {
+      int irq = priority[i];
+      if (pending[irq] && irq_subbed[irq]) {
+        m_ptr->m_notify.interrupts = (uint32_t)1 << irq_hooks[irq];
+        return OK;
+      }
+    }
+
+    /* nothing else to do: wait (virtually) for the next timer 0 tick */
+    if (!irq_subbed[TIMER0_IRQ] && !irq_subbed[RTC_IRQ] &&
+        !irq_subbed[COM1_IRQ])
+      return EINVAL; // nothing would ever wake us up
+
+    clock_advance_us(next_tick_us - vclock_us);
+    if (irq_subbed[TIMER0_IRQ]) {
+      if (!frames++)
+        clock_gettime(CLOCK_MONOTONIC, &sim_beg);
+      m_ptr->m_notify.interrupts = (uint32_t)1 << irq_hooks[TIMER0_IRQ];
+      return OK;
+    }
+  }
+}
+
+/* LCF UTILITIES */
+void*
+lm_alloc(size_t size, mmap_t* map)
+{
+  if (!map)
+    return NULL;
+
+  /* blocks are handed out like a stack (they are freed right after use) */
+  phys_bytes phys = (low_mem_top + 15) & ~15u;
+  if (!low_mem_live)
+    phys = LOW_MEM_BASE;
+  if (size > LOW_MEM_SIZE - phys)
+    return NULL;
+
+  map->phys   = phys;
+  map->virt   = low_mem + phys;
+  map->size   = size;
+  low_mem_top = phys + size;
+  ++low_mem_live;
+
+  return map->virt;
+}
+
+bool
+lm_free(const mmap_t* map)
+{
+  if (!map || !low_mem_live)
+    return false;
+
+  if (map->phys + map->size == low_mem_top)
+    low_mem_top = map->phys;
+  --low_mem_live;
+
+  return true;
+}
+
+int
+tickdelay(clock_t ticks)
+{
+  if (ticks < 0)
+    return EINVAL;
+
+  uint64_t us = (uint64_t)ticks * 1000000 / HAL_HZ;
+  clock_advance_us(us);
+
+  /* the serial peer is a real process: give it (real) time to answer */
+  if (uart_in_fd >= 0) {
+    struct timespec ts = { .tv_sec  = us / 1000000,
+                           .tv_nsec = (us % 1000000) * 1000 + 1000000 };
+    if (ts.tv_nsec >= 1000000000) {
+      ++ts.tv_sec;
+      ts.tv_nsec -= 1000000000;
+    }
+    nanosleep(&ts, NULL);
+  }
+
+  return OK;
+}
+
+clock_t
+micros_to_ticks(uint32_t micros)
+{
+  return (uint64_t)micros * HAL_HZ / 1000000;
+}
+
+int
+vg_exit(void)
+{
+  reg86_t reg86;
+  memset(&reg86, 0, sizeof(reg86));
+
+  reg86.intno = GPUINTNO;
+  reg86.ah    = 0x00; // set video mode
+  reg86.al    = 0x03; // 80x25 text mode
+
+  return sys_int86(&reg86);
+}
+
+int
+vg_display_vbe_contr_info(vg_vbe_contr_info_t* info_p)
+{
+  if (!info_p)
+    return EINVAL;
+
+  printf("VBE signature: %.4s\n", info_p->VBESignature);
+  printf("VBE version: %X.%X\n", info_p->VBEVersion[1], info_p->VBEVersion[0]);
+  printf("Total memory: %" PRIu32 " kB\n", info_p->TotalMemory);
+  return OK;
+}
+
+int
+timer_print_config(uint8_t timer,
+                   enum timer_status_field field,
+                   union timer_status_field_val val)
+{
+  switch (field) {
+    case tsf_all:
+      printf("timer %u: 0x%02X\n", timer, val.byte);
+      break;
+    case tsf_initial:
+      printf("timer %u: init %d\n", timer, val.in_mode);
+      break;
+    case tsf_mode:
+      printf("timer %u: mode %u\n", timer, val.count_mode);
+      break;
+    case tsf_base:
+      printf("timer %u: %s\n", timer, val.bcd ? "bcd" : "binary");
+      break;
+    default:
+      return EINVAL;
+  }
+  return OK;
+}
+
+/* LCF ENTRY POINT */
+int
+lcf_set_language(const char* lang)
+{
+  return OK;
+}
+
+int
+lcf_start(int argc, char* argv[])
+{
+  const char* serial_in  = NULL;
+  const char* serial_out = NULL;
+  int i;
+
+  /* HAL options come first, the rest is for the game */
+  for (i = 1; i < argc && !strncmp(argv[i], "--", 2); ++i) {
+    if (!strcmp(argv[i], "--")) {
+      ++i;
+      break;
+    }
+    if (i + 1 == argc) {
+      print_usage(argv[0]);
+      return 1;
+    }
+
+    if (!strcmp(argv[i], "--input")) {
+      if (hal_load_script(argv[++i]))
+        return 1;
+    }
+    else if (!strcmp(argv[i], "--frames"))
+      max_frames = strtoull(argv[++i], NULL, 10);
+    else if (!strcmp(argv[i], "--screenshot"))
+      screenshot_path = argv[++i];
+    else if (!strcmp(argv[i], "--serial-in"))
+      serial_in = argv[++i];
+    else if (!strcmp(argv[i], "--serial-out"))
+      serial_out = argv[++i];
+    else {
+      print_usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (!serial_in != !serial_out) {
+    hal_warn("the serial port needs both --serial-in and --serial-out");
+    return 1;
+  }
+  if (serial_in && ((uart_in_fd = open_pipe(serial_in, 0)) < 0 ||
+                    (uart_out_fd = open_pipe(serial_out, O_CREAT)) < 0))
+    return 1;
+
+  timer0_update_period();
+  rtc_last_sec = rtc_now_secs();
+  next_tick_us = timer0_period / 1000;
+  clock_gettime(CLOCK_MONOTONIC, &wall_beg);
+  atexit(hal_release);
+
+  return proj_main_loop(argc - i, argv + i);
+}
+
+void
+lcf_cleanup(void)
+{
+  hal_release();
+}
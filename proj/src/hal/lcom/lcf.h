@@ -0,0 +1,237 @@
+/** @file lcf.h */
+#ifndef __LCOM_LCF_H__
+#define __LCOM_LCF_H__
+
+/* Host (Linux) replacement of LCF's main header. Only the types, constants and
+ * calls used by the game are provided. Everything is implemented on top of
+ * the emulated devices in hal_linux.c. */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+
+/** @addtogroup hal_grp
+ * @{
+ */
+
+#ifndef BIT
+#define BIT(n) (1 << (n))
+#endif
+
+#define OK 0 /**< @brief Return value of successful kernel calls */
+
+/* ENDPOINTS AND IPC */
+#define SELF     0x8ace /**< @brief Endpoint of the running process */
+#define ANY      0x7ace /**< @brief Receive from any endpoint */
+#define HARDWARE (-2)   /**< @brief Endpoint of hardware notifications */
+
+#define NOTIFY_MESSAGE 0x1000 /**< @brief Type of notification messages */
+#define _ENDPOINT_P(e) ((int)(e)) /**< @brief Process slot of an endpoint */
+/** @brief Checks whether a received message is a notification. */
+#define is_ipc_notify(ipc_status) ((ipc_status) == NOTIFY_MESSAGE)
+
+/** @brief Message received through driver_receive. */
+typedef struct
+{
+  int m_source; /**< @brief Endpoint that sent the message. */
+  int m_type;   /**< @brief Type of the message. */
+  struct
+  {
+    uint32_t interrupts; /**< @brief Bits of the irqs that were raised. */
+  } m_notify;
+} message;
+
+/* IRQ POLICIES */
+#define IRQ_REENABLE  0x001 /**< @brief Reenable the irq line automatically */
+#define IRQ_EXCLUSIVE 0x002 /**< @brief Exclusive access to the irq line */
+
+/* MEMORY */
+#define SYS_PRIV_ADD_MEM 2 /**< @brief Grant access to a memory range */
+
+/** @brief Physical address (32-bit, like on MINIX). */
+typedef uint32_t phys_bytes;
+
+/** @brief Memory range given to sys_privctl. */
+struct minix_mem_range
+{
+  phys_bytes mr_base;  /**< @brief Lowest memory address in range. */
+  phys_bytes mr_limit; /**< @brief Highest memory address in range. */
+};
+
+/** @brief Low memory (first MiB) mapping. */
+typedef struct
+{
+  phys_bytes phys; /**< @brief Physical address. */
+  void* virt;      /**< @brief Virtual address. */
+  size_t size;     /**< @brief Size of the mapping, in bytes. */
+} mmap_t;
+
+/** @brief Segment of a low memory physical address. */
+#define PB2BASE(x) (((x) >> 4) & 0x0F000)
+/** @brief Offset of a low memory physical address. */
+#define PB2OFF(x) ((x)&0x0FFFF)
+
+/* REAL MODE INTERRUPTS */
+/** @brief Registers given to (and returned by) a real mode interrupt. */
+typedef struct
+{
+  union
+  {
+    uint32_t eax; /**< @brief Full register. */
+    uint16_t ax;  /**< @brief Lower 16 bits. */
+    struct
+    {
+      uint8_t al; /**< @brief Lower 8 bits. */
+      uint8_t ah; /**< @brief Upper 8 bits of ax. */
+    };
+  };
+  union
+  {
+    uint32_t ebx; /**< @brief Full register. */
+    uint16_t bx;  /**< @brief Lower 16 bits. */
+    struct
+    {
+      uint8_t bl; /**< @brief Lower 8 bits. */
+      uint8_t bh; /**< @brief Upper 8 bits of bx. */
+    };
+  };
+  union
+  {
+    uint32_t ecx; /**< @brief Full register. */
+    uint16_t cx;  /**< @brief Lower 16 bits. */
+    struct
+    {
+      uint8_t cl; /**< @brief Lower 8 bits. */
+      uint8_t ch; /**< @brief Upper 8 bits of cx. */
+    };
+  };
+  union
+  {
+    uint32_t edx; /**< @brief Full register. */
+    uint16_t dx;  /**< @brief Lower 16 bits. */
+    struct
+    {
+      uint8_t dl; /**< @brief Lower 8 bits. */
+      uint8_t dh; /**< @brief Upper 8 bits of dx. */
+    };
+  };
+  uint16_t es;   /**< @brief Extra segment. */
+  uint16_t di;   /**< @brief Destination index. */
+  uint8_t intno; /**< @brief Number of the interrupt to call. */
+} reg86_t;
+
+/* VBE */
+#pragma pack(push, 1)
+/** @brief VBE mode information block (VBE 3.0 layout, 256 bytes). */
+typedef struct
+{
+  uint16_t ModeAttributes;
+  uint8_t WinAAttributes;
+  uint8_t WinBAttributes;
+  uint16_t WinGranularity;
+  uint16_t WinSize;
+  uint16_t WinASegment;
+  uint16_t WinBSegment;
+  phys_bytes WinFuncPtr;
+  uint16_t BytesPerScanLine;
+
+  uint16_t XResolution;
+  uint16_t YResolution;
+  uint8_t XCharSize;
+  uint8_t YCharSize;
+  uint8_t NumberOfPlanes;
+  uint8_t BitsPerPixel;
+  uint8_t NumberOfBanks;
+  uint8_t MemoryModel;
+  uint8_t BankSize;
+  uint8_t NumberOfImagePages;
+  uint8_t Reserved1;
+
+  uint8_t RedMaskSize;
+  uint8_t RedFieldPosition;
+  uint8_t GreenMaskSize;
+  uint8_t GreenFieldPosition;
+  uint8_t BlueMaskSize;
+  uint8_t BlueFieldPosition;
+  uint8_t RsvdMaskSize;
+  uint8_t RsvdFieldPosition;
+  uint8_t DirectColorModeInfo;
+
+  phys_bytes PhysBasePtr;
+  uint8_t Reserved2[4];
+  uint8_t Reserved3[2];
+
+  uint16_t LinBytesPerScanLine;
+  uint8_t BnkNumberOfImagePages;
+  uint8_t LinNumberOfImagePages;
+  uint8_t LinRedMaskSize;
+  uint8_t LinRedFieldPosition;
+  uint8_t LinGreenMaskSize;
+  uint8_t LinGreenFieldPosition;
+  uint8_t LinBlueMaskSize;
+  uint8_t LinBlueFieldPosition;
+  uint8_t LinRsvdMaskSize;
+  uint8_t LinRsvdFieldPosition;
+  uint32_t MaxPixelClock;
+  uint8_t Reserved4[190];
+} vbe_mode_info_t;
+#pragma pack(pop)
+
+/** @brief VBE controller information (as displayed by LCF). */
+typedef struct
+{
+  char VBESignature[4];    /**< @brief "VESA". */
+  char VBEVersion[2];      /**< @brief BCD version number. */
+  uint32_t TotalMemory;    /**< @brief Video memory, in kB. */
+  char* OEMString;         /**< @brief OEM name. */
+  uint16_t* VideoModeList; /**< @brief Modes list (0xFFFF terminated). */
+  char* OEMVendorNamePtr;  /**< @brief Vendor name. */
+  char* OEMProductNamePtr; /**< @brief Product name. */
+  char* OEMProductRevPtr;  /**< @brief Product revision. */
+} vg_vbe_contr_info_t;
+
+/* PS/2 MOUSE */
+/** @brief Parsed mouse packet. */
+struct packet
+{
+  uint8_t bytes[3]; /**< @brief Raw bytes of the packet. */
+  bool rb;          /**< @brief Right button pressed. */
+  bool mb;          /**< @brief Middle button pressed. */
+  bool lb;          /**< @brief Left button pressed. */
+  int16_t delta_x;  /**< @brief Horizontal displacement. */
+  int16_t delta_y;  /**< @brief Vertical displacement. */
+  bool x_ov;        /**< @brief Horizontal displacement overflow. */
+  bool y_ov;        /**< @brief Vertical displacement overflow. */
+};
+
+/* KERNEL CALLS */
+int sys_inb(int port, uint32_t* value);
+int sys_outb(int port, uint32_t value);
+int sys_irqsetpolicy(int irq_vec, int policy, int* hook_id);
+int sys_irqrmpolicy(int* hook_id);
+int sys_privctl(int proc_ep, int req, void* p);
+int sys_int86(reg86_t* reg86p);
+void* vm_map_phys(int who, void* phaddr, size_t len);
+int driver_receive(int src, message* m_ptr, int* status_ptr);
+
+/* LCF UTILITIES */
+void* lm_alloc(size_t size, mmap_t* map);
+bool lm_free(const mmap_t* map);
+int tickdelay(clock_t ticks);
+clock_t micros_to_ticks(uint32_t micros);
+int vg_exit(void);
+int vg_display_vbe_contr_info(vg_vbe_contr_info_t* info_p);
+
+/* LCF ENTRY POINT */
+int lcf_set_language(const char* lang);
+int lcf_start(int argc, char* argv[]);
+void lcf_cleanup(void);
+int(proj_main_loop)(int argc, char* argv[]);
+
+/** @} */
+
+#endif // __LCOM_LCF_H__
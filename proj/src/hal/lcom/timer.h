@@ -0,0 +1,57 @@
+/** @file timer.h */
+#ifndef __LCOM_TIMER_H__
+#define __LCOM_TIMER_H__
+
+/* Host (Linux) replacement of LCF's i8254 timer header. */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** @addtogroup hal_grp
+ * @{
+ */
+
+/** @brief Counter initialization modes. */
+enum timer_init
+{
+  INVAL_val,    /**< @brief Invalid initialization mode. */
+  LSB_only,     /**< @brief Initialization only of the LSB. */
+  MSB_only,     /**< @brief Initialization only of the MSB. */
+  MSB_after_LSB /**< @brief Initialization of LSB and MSB, in this order. */
+};
+
+/** @brief Fields of a timer's status byte. */
+enum timer_status_field
+{
+  tsf_all,     /**< @brief Status byte, in hexadecimal. */
+  tsf_initial, /**< @brief Initialization mode. */
+  tsf_mode,    /**< @brief Counting mode. */
+  tsf_base     /**< @brief Counting base. */
+};
+
+/** @brief Value of a given field of a timer's status byte. */
+union timer_status_field_val
+{
+  uint8_t byte;            /**< @brief Status byte. */
+  enum timer_init in_mode; /**< @brief Initialization mode. */
+  uint8_t count_mode;      /**< @brief Counting mode: 0, 1, ..., 5. */
+  bool bcd;                /**< @brief Counting base, true if BCD. */
+};
+
+/**
+ * @brief Prints a field of a timer's configuration.
+ *
+ * @param timer Timer whose configuration is printed (0, 1 or 2).
+ * @param field Field of the configuration to print.
+ * @param val   Value of the field.
+ *
+ * @return  0, on success\n
+ *          1, otherwise.
+ */
+int timer_print_config(uint8_t timer,
+                       enum timer_status_field field,
+                       union timer_status_field_val val);
+
+/** @} */
+
+#endif // __LCOM_TIMER_H__
@@ -0,0 +1,99 @@
+#include <stdlib.h>
+
+#include "include/handle.h"
+
+/* PRIVATE */
+#define HANDLE_IND(handle) ((handle)&0xFFFF)
+#define HANDLE_GEN(handle) ((handle) >> 16)
+
+static int
+handle_table_grow(Handle_Table_t* table)
+{
+  size_t size = table->size ? 2 * table->size : DFLT_HANDLE_SLOTS;
+  if (size > MAX_HANDLE_SLOTS)
+    size = MAX_HANDLE_SLOTS;
+  if (size == table->size)
+    return 1; // full
+
+  Handle_Slot_t* slots =
+    (Handle_Slot_t*)realloc(table->slots, sizeof(Handle_Slot_t) * size);
+  if (!slots)
+    return 1;
+
+  table->slots = slots;
+  table->size  = size;
+  return 0;
+}
+
+static inline Handle_Slot_t*
+handle_slot(Handle_Table_t* table, handle_t handle)
+{
+  if (HANDLE_IND(handle) >= table->end)
+    return NULL;
+
+  Handle_Slot_t* slot = &table->slots[HANDLE_IND(handle)];
+  if (!slot->ptr || slot->gen != HANDLE_GEN(handle))
+    return NULL; // stale
+  return slot;
+}
+
+static inline void
+handle_slot_free(Handle_Table_t* table, uint32_t ind)
+{
+  Handle_Slot_t* slot = &table->slots[ind];
+
+  slot->ptr = NULL;
+  if (++slot->gen == 0) // 0 is kept for the null handle
+    slot->gen = 1;
+  slot->next       = table->free_list;
+  table->free_list = ind + 1;
+}
+
+/* PUBLIC */
+handle_t
+handle_new(Handle_Table_t* table, void* ptr)
+{
+  uint32_t ind;
+  if (table->free_list) {
+    ind              = table->free_list - 1;
+    table->free_list = table->slots[ind].next;
+  }
+  else {
+    if (table->end == table->size && handle_table_grow(table))
+      return 0;
+    ind                   = table->end++;
+    table->slots[ind].gen = 1;
+  }
+
+  table->slots[ind].ptr = ptr;
+  return ((handle_t)table->slots[ind].gen << 16) | ind;
+}
+
+void*
+handle_get(Handle_Table_t* table, handle_t handle)
+{
+  Handle_Slot_t* slot = handle_slot(table, handle);
+  return slot ? slot->ptr : NULL;
+}
+
+bool
+handle_valid(Handle_Table_t* table, handle_t handle)
+{
+  return handle_slot(table, handle) != NULL;
+}
+
+void
+handle_free(Handle_Table_t* table, handle_t handle)
+{
+  if (handle_slot(table, handle))
+    handle_slot_free(table, HANDLE_IND(handle));
+}
+
+void
+handle_table_reset(Handle_Table_t* table)
+{
+  for (size_t i = 0; i < table->end; ++i) {
+    if (table->slots[i].ptr)
+      handle_slot_free(table, i);
+  }
+}
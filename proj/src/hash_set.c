@@ -0,0 +1,83 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "include/hash_set.h"
+
+/* PRIVATE */
+static inline size_t
+hash_set_slot(Hash_Set_t* set, void* elem)
+{
+  /* Fibonacci hashing (the low bits of the pointers are always 0) */
+  uint32_t hash = (uint32_t)((uintptr_t)elem >> 3) * 2654435761u;
+  size_t slot   = hash & (set->capacity - 1);
+
+  while (set->slots[slot] && set->slots[slot] != elem)
+    slot = (slot + 1) & (set->capacity - 1);
+  return slot;
+}
+
+static int
+hash_set_grow(Hash_Set_t* set)
+{
+  void** old_slots    = set->slots;
+  size_t old_capacity = set->capacity;
+
+  void** slots =
+    (void**)arena_alloc(set->arena, sizeof(void*) * 2 * old_capacity);
+  if (!slots)
+    return 1;
+  memset(slots, 0, sizeof(void*) * 2 * old_capacity);
+
+  /* rehash (the old table is left in the arena) */
+  set->slots    = slots;
+  set->capacity = 2 * old_capacity;
+  for (size_t i = 0; i < old_capacity; ++i) {
+    if (old_slots[i])
+      set->slots[hash_set_slot(set, old_slots[i])] = old_slots[i];
+  }
+
+  return 0;
+}
+
+/* PUBLIC */
+Hash_Set_t*
+new_hash_set(Arena_t* arena)
+{
+  Hash_Set_t* set = (Hash_Set_t*)arena_alloc(arena, sizeof(Hash_Set_t));
+  if (!set)
+    return NULL;
+
+  set->slots = (void**)arena_alloc(arena, sizeof(void*) * DFLT_HASH_SET_SIZE);
+  if (!set->slots)
+    return NULL;
+  memset(set->slots, 0, sizeof(void*) * DFLT_HASH_SET_SIZE);
+
+  set->capacity = DFLT_HASH_SET_SIZE;
+  set->end      = 0;
+  set->arena    = arena;
+  return set;
+}
+
+bool
+hash_set_contains(Hash_Set_t* set, void* elem)
+{
+  return set->slots[hash_set_slot(set, elem)] != NULL;
+}
+
+void
+hash_set_insert(Hash_Set_t* set, void* elem)
+{
+  size_t slot = hash_set_slot(set, elem);
+  if (set->slots[slot])
+    return; // already in the set
+
+  /* keep the table at most half full (short probe sequences) */
+  if (2 * (set->end + 1) > set->capacity) {
+    if (hash_set_grow(set))
+      return;
+    slot = hash_set_slot(set, elem);
+  }
+
+  set->slots[slot] = elem;
+  ++set->end;
+}
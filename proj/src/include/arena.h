@@ -0,0 +1,78 @@
+/** @file arena.h */
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stddef.h>
+
+/** @addtogroup	util_grp
+ * @{
+ */
+
+/** Default size of each chunk of an arena, in bytes */
+#define DFLT_ARENA_CHUNK 4096
+/** Alignment of the blocks handed out by an arena (power of 2) */
+#define ARENA_ALIGN 8
+
+/** @struct ARENA_CHUNK_T
+ *  Chunk of memory of an arena (the blocks follow the header).
+ */
+typedef struct ARENA_CHUNK_T
+{
+  struct ARENA_CHUNK_T* next; /**< Previously filled chunk (NULL if none). */
+  size_t size;                /**< Bytes available in the chunk. */
+  size_t used;                /**< Bytes already handed out. */
+} Arena_Chunk_t;
+
+/** @struct ARENA_T
+ *  Linear (bump) allocator: blocks can't be freed one by one, the whole arena
+ * is reset at once. A zeroed Arena_t is a valid empty arena.
+ */
+typedef struct ARENA_T
+{
+  Arena_Chunk_t* chunks; /**< Chunk being filled (NULL if none). */
+  size_t total;          /**< Bytes available in all the chunks. */
+} Arena_t;
+
+/**
+ * @brief Get the arena for the scratch data of the current frame.
+ * @note  It is reset at the end of every game frame: nothing alloced from it
+ * can be kept between frames.
+ *
+ * @return  Pointer to the frame arena.
+ */
+Arena_t* frame_arena(void);
+
+/**
+ * @brief Get a block of memory from an arena (a new chunk is alloced if the
+ * current one is full).
+ *
+ * @param arena Arena to get the block from.
+ * @param size  Size of the block, in bytes.
+ *
+ * @return  Pointer to the block (aligned to ARENA_ALIGN), on success\n
+ *          NULL, otherwise.
+ */
+void* arena_alloc(Arena_t* arena, size_t size);
+
+/**
+ * @brief Give all the blocks back to an arena.
+ * @note  If the blocks didn't fit in a single chunk, the chunks are replaced
+ * by a single one big enough for all of them (so the next uses of the arena
+ * don't need to alloc).
+ * @warning All blocks handed out by the arena become invalid.
+ *
+ * @param arena Arena to reset.
+ */
+void arena_reset(Arena_t* arena);
+
+/**
+ * @brief Free all the chunks of an arena (it is left empty, but valid).
+ * @warning All blocks handed out by the arena become invalid.
+ *
+ * @param arena Arena to free.
+ */
+void arena_free(Arena_t* arena);
+
+/** @} */
+
+#endif // __ARENA_H__
@@ -2,6 +2,7 @@
 #ifndef __BMP_H__
 #define __BMP_H__
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "vg.h"
@@ -12,7 +13,7 @@
 
 #define BMP_SIGN 0x4D42 /**< @brief BM - little endian bitmap file signature */
 
-#pragma pack(1)
+#pragma pack(push, 1)
 /** @struct BMPFILEHEADER_T
  *  struct for the BMP file format headers
  */
@@ -55,7 +56,7 @@ typedef struct BMPV5HEADER_T
   uint32_t ICCProfileSize;
   uint32_t Reserved;
 } BMPV5Header_t;
-#pragma options align = reset
+#pragma pack(pop)
 
 /**
  * @brief	Reads a BMP file, specified by its path and saves its
@@ -64,6 +65,7 @@ typedef struct BMPV5HEADER_T
  * @param file_name	Path (and name) of the BMP file to read the information
  *from.
  * @param sprite	Struct to save the read information to.
+ * @note	The opaque spans of each row are also built (see Sprite_Spans_t).
  *
  * @return	0, on success,\n
  *		1, otherwise.
@@ -126,6 +128,65 @@ Sprite_t* rotate_sprite_intPI(Sprite_t* ori_sprite, int8_t num_turns);
  */
 Sprite_t* sprite_cpy(Sprite_t* orig);
 
+/**
+ * @brief Free the pixel data and the opaque spans of a given sprite.
+ * @note  The sprite struct itself isn't freed.
+ *
+ * @param sprite  Sprite to free the data from.
+ */
+void free_sprite(Sprite_t* sprite);
+
+/**
+ * @brief Checks if the opaque pixels of 2 sprites overlap.
+ * @note  Only the opaque spans of the rows are visited. Sprites without spans
+ * are considered fully opaque.
+ *
+ * @param a   First sprite.
+ * @param ax  X coordinate of the first sprite.
+ * @param ay  Y coordinate of the first sprite.
+ * @param b   Second sprite.
+ * @param bx  X coordinate of the second sprite.
+ * @param by  Y coordinate of the second sprite.
+ *
+ * @return  True, if at least one opaque pixel overlaps\n
+ *          False, otherwise.
+ */
+bool sprite_spans_overlap(Sprite_t* a,
+                          int ax,
+                          int ay,
+                          Sprite_t* b,
+                          int bx,
+                          int by);
+
+/**
+ * @brief Checks if the opaque pixels of 2 sprites overlap inside a given area
+ * (rectangle).
+ *
+ * @param a   First sprite.
+ * @param ax  X coordinate of the first sprite.
+ * @param ay  Y coordinate of the first sprite.
+ * @param b   Second sprite (NULL means the whole area is opaque).
+ * @param bx  X coordinate of the second sprite.
+ * @param by  Y coordinate of the second sprite.
+ * @param x   X coordinate of the area.
+ * @param y   Y coordinate of the area.
+ * @param w   Width of the area.
+ * @param h   Height of the area.
+ *
+ * @return  True, if at least one opaque pixel overlaps inside the area\n
+ *          False, otherwise.
+ */
+bool sprite_spans_overlap_in(Sprite_t* a,
+                             int ax,
+                             int ay,
+                             Sprite_t* b,
+                             int bx,
+                             int by,
+                             int x,
+                             int y,
+                             int w,
+                             int h);
+
 /** @} */
 
 #endif // __BMP_H__
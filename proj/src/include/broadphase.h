@@ -0,0 +1,190 @@
+/** @file broadphase.h */
+#ifndef __BROADPHASE_H__
+#define __BROADPHASE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "hash_set.h"
+#include "vector.h"
+#include "vg.h"
+
+/** @addtogroup object_grp
+ * @{
+ */
+
+/** @enum BP_SHAPE_T
+ *  Shape of the area claimed by a broadphase entry.
+ */
+typedef enum BP_SHAPE_T {
+  BP_RECT,      /**< The whole area (or the opaque pixels of its sprite). */
+  BP_BAND_DOWN, /**< 45 degree band of squares going down to the right. */
+  BP_BAND_UP    /**< 45 degree band of squares going down to the left. */
+} bp_shape;
+
+/** @struct BROADPHASE_ENTRY_T
+ *  Area of the screen claimed by an object during the current frame.
+ */
+typedef struct BROADPHASE_ENTRY_T
+{
+  void* obj;      /**< Derived object that claimed the area. */
+  uint16_t x;     /**< Horizontal coordinate of the area (clipped to screen). */
+  uint16_t y;     /**< Vertical coordinate of the area (clipped to screen). */
+  uint16_t w;     /**< Width of the area (clipped to screen). */
+  uint16_t h;     /**< Height of the area (clipped to screen). */
+  Sprite_t* spr;  /**< Sprite with the opaque pixels (NULL for solid areas). */
+  uint32_t stamp; /**< Last query that visited this entry. */
+  uint8_t shape;  /**< Shape inside the area (bp_shape). */
+  uint16_t len;   /**< Number of squares of a band. */
+  uint16_t size;  /**< Side of the squares of a band. */
+} Broadphase_Entry_t;
+
+/** @struct BROADPHASE_T
+ *  Uniform grid (spatial hash) used to find collision candidates.
+ *  Each cell holds the indexes of the entries whose area overlaps it.
+ *  Areas that never move are baked once to a static layer (see
+ * broadphase_static_begin()), that is only queried (never rebuilt).
+ */
+typedef struct BROADPHASE_T
+{
+  uint16_t h_res;     /**< Horizontal resolution covered by the grid. */
+  uint16_t v_res;     /**< Vertical resolution covered by the grid. */
+  uint16_t cell_size; /**< Side of each (square) cell, in pixels. */
+  uint16_t cols;      /**< Number of cell columns. */
+  uint16_t rows;      /**< Number of cell rows. */
+  vector** cells;     /**< Cell buckets (cols * rows) of entry indexes. */
+  vector* used_cells; /**< Indexes of the cells that aren't empty. */
+
+  Broadphase_Entry_t* entries; /**< Entries inserted this frame. */
+  size_t entries_end;          /**< Number of entries inserted this frame. */
+  size_t entries_size;         /**< Number of entries alloced. */
+  uint32_t stamp;              /**< Current query stamp. */
+
+  /** @name Static layer (cells stored one after the other). */
+  /*@{*/
+  Broadphase_Entry_t* static_entries; /**< Entries of the static layer. */
+  size_t static_end;                  /**< Number of static entries. */
+  uint32_t* static_start;             /**< Start of each cell in static_inds. */
+  uint32_t* static_inds;              /**< Static entry indexes by cell. */
+  uint32_t* static_bits;              /**< Cells with static entries. */
+  bool baking;                        /**< Inserts go to the static layer. */
+  /*@}*/
+} Broadphase_t;
+
+/**
+ * @brief Creates a new broadphase grid covering a given screen area.
+ *
+ * @param h_res     Horizontal resolution of the area to cover.
+ * @param v_res     Vertical resolution of the area to cover.
+ * @param cell_size Side of each cell of the grid, in pixels.
+ *
+ * @return  Pointer to the new broadphase grid, on success\n
+ *          NULL, otherwise.
+ */
+Broadphase_t* new_broadphase(uint16_t h_res,
+                             uint16_t v_res,
+                             uint16_t cell_size);
+
+/**
+ * @brief Frees a broadphase grid and all its cells.
+ * @param bp  Broadphase grid to free.
+ */
+void free_broadphase(Broadphase_t* bp);
+
+/**
+ * @brief Empties out all the cells of a broadphase grid.
+ * @note  Only the cells used during the last frame are visited. The static
+ * layer is kept.
+ *
+ * @param bp  Broadphase grid to clear.
+ */
+void broadphase_clear(Broadphase_t* bp);
+
+/**
+ * @brief Starts baking the static layer of a broadphase grid: the areas
+ * inserted until broadphase_static_end() are kept in the static layer (and
+ * don't collide with anything while being inserted). The old static layer is
+ * freed.
+ * @note  Only for areas that never move (nor change), e.g.: the walls.
+ *
+ * @param bp  Broadphase grid to bake.
+ */
+void broadphase_static_begin(Broadphase_t* bp);
+
+/**
+ * @brief Finishes baking the static layer of a broadphase grid. The areas
+ * inserted afterwards are checked against the static layer directly (the
+ * static areas are never inserted again).
+ * @note  The (dynamic) cells are cleared.
+ *
+ * @param bp  Broadphase grid to bake.
+ *
+ * @return  0, on success\n
+ *          1, otherwise (the static layer is left empty).
+ */
+int broadphase_static_end(Broadphase_t* bp);
+
+/**
+ * @brief Frees the static layer of a broadphase grid.
+ * @param bp  Broadphase grid to work on.
+ */
+void broadphase_static_clear(Broadphase_t* bp);
+
+/**
+ * @brief Inserts an area claimed by an object into the broadphase grid.
+ * Candidates sharing a cell with the area are checked pixel by pixel (only
+ * opaque pixels of sprites count) and every object found overlapping is passed
+ * to the collision_dispatcher (once per object).
+ * @note  Entries of the same object never collide with each other.
+ *
+ * @param bp                    Broadphase grid to update.
+ * @param obj                   Object claiming the area.
+ * @param x                     Horizontal coordinate of the area.
+ * @param y                     Vertical coordinate of the area.
+ * @param w                     Width of the area.
+ * @param h                     Height of the area.
+ * @param spr                   Sprite of the area (NULL for solid areas).
+ * @param already_collided_objs Objects that were already dispatched (won't be
+ * dispatched again). Every newly dispatched object is inserted in it.
+ */
+void broadphase_insert(Broadphase_t* bp,
+                       void* obj,
+                       uint16_t x,
+                       uint16_t y,
+                       uint16_t w,
+                       uint16_t h,
+                       Sprite_t* spr,
+                       Hash_Set_t* already_collided_objs);
+
+/**
+ * @brief Inserts a 45 degree band of solid squares claimed by an object into
+ * the broadphase grid (see broadphase_insert()). Square i is offset by i
+ * pixels down and i pixels right (down is true) or left (down is false) from
+ * the first one.
+ * @note  The band is a single entry, that only claims the cells it crosses.
+ *
+ * @param bp                    Broadphase grid to update.
+ * @param obj                   Object claiming the band.
+ * @param x                     Horizontal coordinate of the band's bounding
+ * box.
+ * @param y                     Vertical coordinate of the band's bounding box.
+ * @param len                   Number of squares.
+ * @param size                  Side of the squares.
+ * @param down                  Whether the band goes down to the right (or to
+ * the left).
+ * @param already_collided_objs Objects that were already dispatched (won't be
+ * dispatched again). Every newly dispatched object is inserted in it.
+ */
+void broadphase_insert_band(Broadphase_t* bp,
+                            void* obj,
+                            uint16_t x,
+                            uint16_t y,
+                            uint16_t len,
+                            uint16_t size,
+                            bool down,
+                            Hash_Set_t* already_collided_objs);
+
+/**@}*/
+
+#endif // __BROADPHASE_H__
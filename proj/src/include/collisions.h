@@ -8,6 +8,8 @@
 
 /**
  * @brief Dispatcher for the collisions between objects.
+ * @note  The handler is looked up in a table indexed by the types of both
+ * objects (pairs without a handler don't interact).
  *
  * @param obj1  First object in collision.
  * @param obj2  Second object in collision.
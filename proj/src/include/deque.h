@@ -0,0 +1,157 @@
+/** @file deque.h */
+#ifndef __DEQUE_H__
+#define __DEQUE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/** @addtogroup	util_grp
+ * @{
+ */
+
+/** Default starting capacity of a deque object (must be a power of 2) */
+#define DFLT_DEQUE_SIZE 16
+
+/** @struct DEQUE_T
+ *  Double-ended queue of fixed-size elements stored by value in a growable
+ * ring buffer (pushing and popping at both ends don't move the elements).
+ */
+typedef struct DEQUE_T
+{
+  char* data;       /**< ring buffer */
+  size_t elem_size; /**< size of each element, in bytes */
+  size_t capacity;  /**< number of elements in the ring buffer (power of 2) */
+  size_t front;     /**< free-running position of the first element */
+  size_t back;      /**< free-running position after the last element */
+} Deque_t;
+
+/**
+ * @brief Creates a new deque object.
+ *
+ * @param elem_size Size of each element, in bytes.
+ *
+ * @return  Pointer to the new deque object, on success\n
+ *          NULL, otherwise.
+ */
+Deque_t* new_deque(size_t elem_size);
+
+/**
+ * @brief Free a deque object and its elements.
+ * @param deque Deque to free.
+ */
+void free_deque(Deque_t* deque);
+
+/**
+ * @brief Get the number of elements in a given deque.
+ *
+ * @param deque Deque to check.
+ *
+ * @return  Number of elements in the deque.
+ */
+size_t deque_size(Deque_t* deque);
+
+/**
+ * @brief Checks if a given deque is empty.
+ *
+ * @param deque Deque to check.
+ *
+ * @return  True, if it is empty\n
+ *          False, otherwise.
+ */
+bool deque_empty(Deque_t* deque);
+
+/**
+ * @brief Get a pointer to the element at a given position (0 is the front).
+ * @warning The pointer is only valid until the next push.
+ *
+ * @param deque Deque to get the element from.
+ * @param i     Position of the element (from the front).
+ *
+ * @return  Pointer to the element, on success\n
+ *          NULL, otherwise.
+ */
+void* deque_at(Deque_t* deque, size_t i);
+
+/**
+ * @brief Get a pointer to the first element of a deque.
+ *
+ * @param deque Deque to get the element from.
+ *
+ * @return  Pointer to the first element, on success\n
+ *          NULL, otherwise.
+ */
+void* deque_front(Deque_t* deque);
+
+/**
+ * @brief Get a pointer to the last element of a deque.
+ *
+ * @param deque Deque to get the element from.
+ *
+ * @return  Pointer to the last element, on success\n
+ *          NULL, otherwise.
+ */
+void* deque_back(Deque_t* deque);
+
+/**
+ * @brief Add an element to the front of a deque (the ring buffer doubles in
+ * size if it is full).
+ * @note  The new element isn't initialized: write it through the returned
+ * pointer.
+ *
+ * @param deque Deque to push the element into.
+ *
+ * @return  Pointer to the new element, on success\n
+ *          NULL, otherwise.
+ */
+void* deque_push_front(Deque_t* deque);
+
+/**
+ * @brief Add an element to the back of a deque (the ring buffer doubles in
+ * size if it is full).
+ * @note  The new element isn't initialized: write it through the returned
+ * pointer.
+ *
+ * @param deque Deque to push the element into.
+ *
+ * @return  Pointer to the new element, on success\n
+ *          NULL, otherwise.
+ */
+void* deque_push_back(Deque_t* deque);
+
+/**
+ * @brief Remove the first element of a deque (if any).
+ * @param deque Deque to remove the element from.
+ */
+void deque_pop_front(Deque_t* deque);
+
+/**
+ * @brief Remove the last element of a deque (if any).
+ * @param deque Deque to remove the element from.
+ */
+void deque_pop_back(Deque_t* deque);
+
+/**
+ * @brief Remove all the elements of a deque (the ring buffer is kept).
+ * @param deque Deque to clear.
+ */
+void deque_clear(Deque_t* deque);
+
+/**
+ * @brief Iterate a deque from front to back. Starts with NULL and returns the
+ * element after a given one:
+ * @code
+ * for (seg* s = deque_next(d, NULL); s; s = deque_next(d, s))
+ * @endcode
+ * @warning The deque mustn't be pushed into while iterating.
+ *
+ * @param deque Deque to iterate.
+ * @param elem  Current element (NULL to get the first one).
+ *
+ * @return  Pointer to the next element,\n
+ *          NULL, at the end of the deque.
+ */
+void* deque_next(Deque_t* deque, void* elem);
+
+/** @} */
+
+#endif // __DEQUE_H__
@@ -75,6 +75,18 @@ Enemy_t* new_enemy(float x,
  */
 void enemy_take_damage(Enemy_t* enemy, uint8_t damage);
 
+/**
+ * @brief Updates the positions of a batch of enemies (e.g.: the whole ENEMY
+ * layer), in a single loop.
+ * @note  The steering is a small part of a frame (the collisions take most of
+ * it, even with 10k enemies), so it is kept scalar and reads the enemies in
+ * place.
+ *
+ * @param enemies Array of enemies (Enemy_t*).
+ * @param n       Number of enemies in the array.
+ */
+void update_enemies(void** enemies, size_t n);
+
 /**@}*/
 
 #endif // __ENEMIES_H__
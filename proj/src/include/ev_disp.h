@@ -51,6 +51,34 @@ void set_resourcepath(const char* const path);
  */
 void set_videomode(const uint16_t mode);
 
+/**
+ * @brief Seeds the game's random number generator with a fixed value.
+ *
+ * @note Default is seeding with the current time.
+ * @warning Must be set before calling the game init function.
+ *
+ * @param seed  Seed to use (same seed and input give the same game).
+ */
+void set_seed(const unsigned seed);
+
+/**
+ * @brief Runs the game without drawing anything (simulation only).
+ *
+ * @note Objects are still "rendered" (animations and sprites are updated), but
+ * no pixel is written and the frame buffers are never switched.
+ * @warning Must be set before calling the game init function.
+ */
+void set_headless(void);
+
+/**
+ * @brief Draws the frames to system memory, copying only what changed to video
+ * memory (see vg_set_ram_buff()).
+ *
+ * @note Default is drawing to video memory.
+ * @warning Must be set before calling the game init function.
+ */
+void set_ram_buff(void);
+
 /**@}*/
 
 #endif // __EV_DISP_H__
@@ -0,0 +1,106 @@
+/** @file flow_field.h */
+#ifndef __FLOW_FIELD_H__
+#define __FLOW_FIELD_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** @addtogroup object_grp
+ * @{
+ */
+
+/** Distance of the cells that can't reach the target */
+#define FLOW_UNREACHED UINT16_MAX
+/** Direction of the cells that have no next cell (target or unreached) */
+#define FLOW_NO_DIREC 8
+
+/** @struct FLOW_FIELD_T
+ *  Flow field leading to a target over a coarse grid of the screen: each cell
+ * knows the next cell on a shortest path (around the blocked cells) to the
+ * cell of the target. The field is only recomputed when the target moves to
+ * another cell, and is sampled in constant time by everyone chasing it.
+ */
+typedef struct FLOW_FIELD_T
+{
+  uint16_t h_res;     /**< Horizontal resolution covered by the field. */
+  uint16_t v_res;     /**< Vertical resolution covered by the field. */
+  uint16_t cell_size; /**< Side of each (square) cell, in pixels. */
+  uint16_t cols;      /**< Number of cell columns. */
+  uint16_t rows;      /**< Number of cell rows. */
+  uint8_t* blocked;   /**< Cells that can't be walked through. */
+  uint16_t* dist;     /**< Steps from each cell to the target cell. */
+  uint8_t* next;      /**< Direction of the next cell towards the target. */
+  uint8_t* sight;     /**< Line of sight to the target cell (0 if unknown). */
+  uint32_t* queue;    /**< Cells to visit while computing the field. */
+  int32_t target;     /**< Cell of the target (-1 if the field is stale). */
+} Flow_Field_t;
+
+/**
+ * @brief Creates a new flow field (without blocked cells) covering a given
+ * screen area.
+ *
+ * @param h_res     Horizontal resolution of the area to cover.
+ * @param v_res     Vertical resolution of the area to cover.
+ * @param cell_size Side of each cell of the field, in pixels.
+ *
+ * @return  Pointer to the new flow field, on success\n
+ *          NULL, otherwise.
+ */
+Flow_Field_t* new_flow_field(uint16_t h_res,
+                             uint16_t v_res,
+                             uint16_t cell_size);
+
+/**
+ * @brief Frees a flow field.
+ * @param ff  Flow field to free (can be NULL).
+ */
+void free_flow_field(Flow_Field_t* ff);
+
+/**
+ * @brief Blocks the cells overlapped by a given area (e.g.: a wall).
+ * @note  The field is recomputed the next time it is targeted.
+ *
+ * @param ff  Flow field to work on.
+ * @param x   Horizontal coordinate of the area.
+ * @param y   Vertical coordinate of the area.
+ * @param w   Width of the area.
+ * @param h   Height of the area.
+ */
+void flow_field_block(Flow_Field_t* ff, float x, float y, float w, float h);
+
+/**
+ * @brief Sets the target of a flow field. The field is only recomputed if the
+ * target is on another cell than before.
+ *
+ * @param ff  Flow field to work on.
+ * @param x   Horizontal coordinate of the target.
+ * @param y   Vertical coordinate of the target.
+ */
+void flow_field_target(Flow_Field_t* ff, float x, float y);
+
+/**
+ * @brief Get the point someone at a given position should head to, in order
+ * to reach the target of a flow field.
+ * @note  Those that can see the target cell (or are on a blocked cell, or
+ * can't reach the target) should head straight to the target.
+ *
+ * @param ff  Flow field to sample.
+ * @param x   Horizontal coordinate of the position.
+ * @param y   Vertical coordinate of the position.
+ * @param wx  Horizontal coordinate of the point to head to (only set on
+ * detours).
+ * @param wy  Vertical coordinate of the point to head to (only set on
+ * detours).
+ *
+ * @return  True, if the point is the center of the next cell (detour)\n
+ *          False, if the target should be chased in a straight line.
+ */
+bool flow_field_waypoint(Flow_Field_t* ff,
+                         float x,
+                         float y,
+                         float* wx,
+                         float* wy);
+
+/** @} */
+
+#endif // __FLOW_FIELD_H__
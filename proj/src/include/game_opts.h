@@ -4,6 +4,8 @@
 
 #include <string.h>
 
+#include "include/i8254.h"
+
 /** @defgroup game_grp Game state/config */
 
 /** @addtogroup game_grp
@@ -134,6 +136,14 @@ make_path(const char* const file)
 /** @brief Skane 2 spawner sprite */
 #define SKA2_SPAWNER "/skane2/skane2Spawner.bmp"
 
+/* simulation (fixed timestep): the speeds are per simulation step */
+#define TICK_HZ       TIMER0_FREQ /**< @brief Timer 0 interrupts per second. */
+#define SIM_HZ        60          /**< @brief Simulation steps per second. */
+#define SIM_MAX_STEPS 4 /**< @brief Most steps run in a tick (catching up). */
+#define SIM_MAX_DROPS 3 /**< @brief Most frames dropped in a row. */
+/** @brief Ticks the game can lose (according to the RTC) before catching up. */
+#define SIM_LAG_SLACK 2
+
 /* skane defaults */
 #define SKA_X             100 /**< @brief Skane default start X location */
 #define SKA_Y             50  /**< @brief Skane default start Y location */
@@ -162,6 +172,11 @@ make_path(const char* const file)
 #define ENE_MAX_GRPSIZE  3  /**< @brief Enemy spawn max group size. */
 #define ENE_MIN_GRPSIZE  1  /**< @brief Enemy spawn min group size. */
 
+/* object pools (blocks preallocated per pooled object type) */
+#define MIS_POOL_SIZE  64  /**< @brief Missiles preallocated per game. */
+#define ENE_POOL_SIZE  256 /**< @brief Enemies preallocated per game. */
+#define FOOD_POOL_SIZE 256 /**< @brief Food preallocated per game. */
+
 /* difficulty scaling */
 /** @brief Enemies' group size increase. */
 #define ENE_GRP_SCALE 0.5f
@@ -0,0 +1,96 @@
+/** @file handle.h */
+#ifndef __HANDLE_H__
+#define __HANDLE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** @addtogroup	util_grp
+ * @{
+ */
+
+/** Default starting number of slots of a handle table */
+#define DFLT_HANDLE_SLOTS 64
+/** Maximum number of slots of a handle table (the index has 16 bits) */
+#define MAX_HANDLE_SLOTS 0x10000
+
+/** @brief Handle of an entry: generation (high 16 bits) and index (low 16
+ * bits) of its slot. 0 is never a valid handle. */
+typedef uint32_t handle_t;
+
+/** @struct HANDLE_SLOT_T
+ *  Slot of a handle table.
+ */
+typedef struct HANDLE_SLOT_T
+{
+  void* ptr;     /**< Entry of the slot (NULL if the slot is free). */
+  uint16_t gen;  /**< Current generation of the slot (never 0). */
+  uint32_t next; /**< Next free slot (only if this one is free). */
+} Handle_Slot_t;
+
+/** @struct HANDLE_TABLE_T
+ *  Table of generational handles: each entry gets a slot, and its handle
+ * stops being valid (stale) once it is freed, even if the slot is reused
+ * later. Lookup, validation and freeing are constant time.
+ *  A zeroed Handle_Table_t is a valid empty table.
+ */
+typedef struct HANDLE_TABLE_T
+{
+  Handle_Slot_t* slots; /**< Slots of the table. */
+  size_t size;          /**< Number of slots alloced. */
+  size_t end;           /**< Number of slots ever used. */
+  uint32_t free_list;   /**< First free slot + 1 (0 if none). */
+} Handle_Table_t;
+
+/**
+ * @brief Get a new handle for a given entry (the table doubles in size if it
+ * is full).
+ *
+ * @param table Table to get the handle from.
+ * @param ptr   Entry of the handle (mustn't be NULL).
+ *
+ * @return  The new handle, on success\n
+ *          0, otherwise.
+ */
+handle_t handle_new(Handle_Table_t* table, void* ptr);
+
+/**
+ * @brief Get the entry of a given handle.
+ *
+ * @param table   Table of the handle.
+ * @param handle  Handle to look up.
+ *
+ * @return  The entry of the handle, if it is valid\n
+ *          NULL, if the handle is stale (or 0).
+ */
+void* handle_get(Handle_Table_t* table, handle_t handle);
+
+/**
+ * @brief Checks if a given handle is valid (not stale nor 0).
+ *
+ * @param table   Table of the handle.
+ * @param handle  Handle to check.
+ *
+ * @return  True, if the handle is valid\n
+ *          False, otherwise.
+ */
+bool handle_valid(Handle_Table_t* table, handle_t handle);
+
+/**
+ * @brief Frees a handle (it becomes stale). Stale handles are ignored.
+ *
+ * @param table   Table of the handle.
+ * @param handle  Handle to free.
+ */
+void handle_free(Handle_Table_t* table, handle_t handle);
+
+/**
+ * @brief Frees all the handles of a table (the slots are kept alloced).
+ * @param table Table to reset.
+ */
+void handle_table_reset(Handle_Table_t* table);
+
+/** @} */
+
+#endif // __HANDLE_H__
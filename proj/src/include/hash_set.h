@@ -0,0 +1,64 @@
+/** @file hash_set.h */
+#ifndef __HASH_SET_H__
+#define __HASH_SET_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "arena.h"
+
+/** @addtogroup	util_grp
+ * @{
+ */
+
+/** Default starting capacity of a hash set (must be a power of 2) */
+#define DFLT_HASH_SET_SIZE 16
+
+/** @struct HASH_SET_T
+ *  Set of (non NULL) pointers: open addressing hash table with linear probing,
+ * alloced from an arena.
+ */
+typedef struct HASH_SET_T
+{
+  void** slots;    /**< Table of elements (NULL slots are empty). */
+  size_t capacity; /**< Number of slots (power of 2). */
+  size_t end;      /**< Number of elements in the set. */
+  Arena_t* arena;  /**< Arena the set (and its table) come from. */
+} Hash_Set_t;
+
+/**
+ * @brief   Creates a new (empty) hash set in a given arena.
+ * @note    Used for scratch data, e.g.: frame_arena(). The set doesn't need to
+ * be freed, it is gone when the arena is reset.
+ *
+ * @param arena Arena to alloc the set from.
+ *
+ * @return  Pointer to the new hash set, on success\n
+ *          NULL, otherwise.
+ */
+Hash_Set_t* new_hash_set(Arena_t* arena);
+
+/**
+ * @brief Checks if a given element is in a given set, in constant time.
+ *
+ * @param set   Set to search.
+ * @param elem  Element to find.
+ *
+ * @return  True, if the element is in the set\n
+ *          False, otherwise.
+ */
+bool hash_set_contains(Hash_Set_t* set, void* elem);
+
+/**
+ * @brief Inserts an element into a given set (the table doubles in size when
+ * it gets half full).
+ * @warning The element is dropped if there isn't memory to grow the table.
+ *
+ * @param set   Set to insert the element into.
+ * @param elem  Element to insert (mustn't be NULL).
+ */
+void hash_set_insert(Hash_Set_t* set, void* elem);
+
+/** @} */
+
+#endif // __HASH_SET_H__
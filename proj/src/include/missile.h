@@ -18,11 +18,16 @@ typedef struct MISSLE_T
   const Object_Vtable_t* vtable; /**< Virtual table of the object 'class'. */
   Object_t* obj;                 /**< Pointer to the Object_t of the missle. */
   uint16_t damage;               /**< Damage of the missle. */
-  uint8_t my_ska;                /**< Id of the skane that shot the missle. */
+  uint32_t my_ska;               /**< Id of the skane that shot the missle. */
+  float prev_x; /**< Horizontal position before the last movement. */
+  float prev_y; /**< Vertical position before the last movement. */
 } Missle_t;
 
 /**
  * @brief   Creates a new Missle_t.
+ * @note    Missles collide along the whole path they moved in the last frame
+ * (not only at their new position), so they can't go through anything, no
+ * matter how fast they are.
  *
  * @param speed_x Horizontal speed of the missle.
  * @param speed_y Vertical speed of the missle.
@@ -40,7 +45,16 @@ Missle_t* new_missle(float speed_x,
                      float y,
                      Sprite_t* sprite,
                      uint16_t damage,
-                     uint8_t my_ska);
+                     uint32_t my_ska);
+
+/**
+ * @brief Updates the positions of a batch of missles (e.g.: the whole MISSILE
+ * layer), in a single loop.
+ *
+ * @param missles Array of missles (Missle_t*).
+ * @param n       Number of missles in the array.
+ */
+void update_missles(void** missles, size_t n);
 
 /**@}*/
 
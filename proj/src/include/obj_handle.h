@@ -12,19 +12,29 @@
  * @{
  */
 
-/** Render all objects, in the objects matrix, on screen. */
-void render_objects(void);
+/**
+ * @brief Render all objects, in the objects matrix, on screen.
+ * @note  The objects are drawn between their positions at the start and at
+ * the end of the last simulation step (interpolated).
+ *
+ * @param lag Fraction of a step the screen is behind the simulation (0 draws
+ * the current positions).
+ */
+void render_objects(float lag);
+
+/** Save the positions of all objects at the start of a simulation step. */
+void save_objs_pos(void);
 
 /** Calculate new positions of all objects, in the objects matrix. */
 void calc_objs_pos(void);
 
-/** Empty out the collision matrix. */
+/** Empty out the collision grid. */
 void clear_collision_matrix(void);
 
-/** Update the collision matrix for all the objects. */
+/** Update the collision grid for all the objects. */
 void update_objs_collisions(void);
 
-/** Debug function that draws the collision matrix on screen. */
+/** Debug function that draws the collision grid entries on screen. */
 void debug_collisions(void);
 
 /**
@@ -40,9 +50,35 @@ void destroy_all_objects(void);
 /** Allocate the object matrix. */
 void alloc_obj_matrix(void);
 
-/** Allocate the collision matrix. */
+/** Allocate the collision grid (frees the previous one, if any). */
 void alloc_collison_matrix(void);
 
+/**
+ * @brief Allocate the object pools (missiles, enemies and food). If they
+ * already exist, they're reset instead.
+ */
+void alloc_obj_pools(void);
+
+/**
+ * @brief Get a block for a new object of a pooled type (MISSILE, ENEMY or
+ * FOOD).
+ * @note  The block holds the derived object followed by its base Object_t.
+ *
+ * @param type  Type of the object.
+ *
+ * @return  Pointer to the block, on success\n
+ *          NULL, otherwise.
+ */
+void* obj_pool_alloc(obj_type type);
+
+/**
+ * @brief Give the block of a pooled object back to its pool.
+ *
+ * @param type  Type of the object.
+ * @param block Block of the object.
+ */
+void obj_pool_free(obj_type type, void* block);
+
 /**
  * @brief Adds a given object the object vector.
  *
@@ -52,13 +88,41 @@ void alloc_collison_matrix(void);
 int add_object(void* object_to_be_added, int layer);
 
 /**
- * @brief	Removes an object with a given id and type from the game objects
- * matrix
+ * @brief	Removes the object with a given id from the game objects matrix. The
+ * object is killed, and the garbage collector destroys it at the end of the
+ * frame. Stale ids are ignored.
+ *
+ * @param object_id		Id (handle) of the object to delete
+ */
+void remove_object(uint32_t object_id);
+
+/**
+ * @brief Get a new id for a game object: a generational handle, so the ids of
+ * dead objects never match a live one.
+ *
+ * @param object  Object (derived) the id refers to.
+ *
+ * @return  The new id, on success\n
+ *          0, if there aren't ids left.
+ */
+uint32_t new_obj_id(void* object);
+
+/**
+ * @brief Get the object of a given id, in constant time.
+ *
+ * @param object_id Id (handle) of the object.
  *
- * @param object_id		Id of the object to delete
- * @param object_type	Type of the object to delete
+ * @return  Pointer to the object (derived), if it is alive\n
+ *          NULL, otherwise.
+ */
+void* get_obj(uint32_t object_id);
+
+/**
+ * @brief Kills an object: frees its id and tags it (id 0) to be destroyed by
+ * the garbage collector.
+ * @param obj Object to kill.
  */
-void remove_object(int object_id, int object_type);
+void kill_object(Object_t* obj);
 
 /** Frees and dereferences menu pointers if defined. */
 void delete_menus(void);
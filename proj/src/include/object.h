@@ -5,6 +5,7 @@
 #include <stdbool.h>
 #include <stdlib.h>
 
+#include "broadphase.h"
 #include "game_opts.h"
 #include "vector.h"
 #include "vg.h"
@@ -63,7 +64,7 @@ typedef enum OBJ_TYPE {
  */
 typedef struct OBJECT_IDENTIFIER_T
 {
-  uint8_t id;    /**< ID of the object. */
+  uint32_t id;   /**< Handle of the object (0 if it is dead). */
   obj_type type; /**< Type of the object. */
 } Object_Identifier_t;
 
@@ -78,8 +79,8 @@ typedef struct OBJECT_VTABLE_T
   void (*print)(void*); /**< Prints all the information of a given object. */
   void (*updatePos)(void*); /**< Updates the position of a given object. */
   void (*destroy)(void*);   /**< Destructor of the object. */
-  /** Update collision matrix of the object. */
-  void (*updateCollision)(void*, vector*);
+  /** Update collision grid with the object. */
+  void (*updateCollision)(void*, Broadphase_t*);
 } Object_Vtable_t;
 
 /** @struct OBJECT_T
@@ -99,6 +100,8 @@ typedef struct OBJECT_T
   float speed_y; /**< Vertical velocity of the object. */
   float x;       /**< Current horizontal position of the object. */
   float y;       /**< Current vertical position of the object. */
+  float prev_x;  /**< Horizontal position at the start of the last step. */
+  float prev_y;  /**< Vertical position at the start of the last step. */
   /*@}*/
 
   /** @name Sprite related parameters. */
@@ -139,53 +142,89 @@ Object_t* new_object(float speed_x,
                      Sprite_t* sprite);
 
 /**
- * @brief	Updates the object of an area delimited by a given x, y, height
- *and width (basically a rectangle) of a given collision matrix.
- * @note Any type of collision due to object overlab is handled by calling the
- *collision_dispatcher.
+ * @brief       Initializes an already alloced Object_t (e.g.: one that came
+ * from an object pool).
  *
- * @param obj         Object to be refered to in the selected points of the
- *matrix
- * @param col_matrix  The collision matrix to update
- * @param x				    Starting X coordinate of the
- *rectangle to update
- * @param y				    Starting Y coordinate of the
- *rectangle point to update
- * @param height			Height of the rectangle
+ * @param obj           Object to initialize.
+ * @param speed_x       Horizontal speed of the object.
+ * @param speed_y       Vertical speed of the object.
+ * @param x             Starting horizontal position of the object.
+ * @param y             Starting vertical position of the object.
+ * @param sprite        Sprite of the object.
+ */
+void init_object(Object_t* obj,
+                 float speed_x,
+                 float speed_y,
+                 float x,
+                 float y,
+                 Sprite_t* sprite);
+
+/**
+ * @brief	Inserts the area delimited by a given x, y, width and height
+ * (basically a rectangle) of an object into a given collision grid.
+ * @note Any type of collision due to object overlap is handled by calling the
+ * collision_dispatcher.
+ *
+ * @param obj         Object that claims the area of the grid
+ * @param col_grid    The collision grid to update
+ * @param x				    Starting X coordinate of the rectangle to update
+ * @param y				    Starting Y coordinate of the rectangle to update
  * @param width				Width of the rectangle
- * @param already_collided_objs Pointer to the vector of collided objects.
+ * @param height			Height of the rectangle
+ * @param already_collided_objs Pointer to the set of collided objects.
  */
 void updateCollisionMatrixRect(void* obj,
-                               vector* col_matrix,
+                               Broadphase_t* col_grid,
                                uint16_t x,
                                uint16_t y,
                                uint16_t width,
                                uint16_t height,
-                               vector* already_collided_objs);
+                               Hash_Set_t* already_collided_objs);
+
+/**
+ * @brief	Inserts a 45 degree band of squares (each one offset by a pixel in
+ * both directions from the previous one) of an object into a given collision
+ * grid, as a single shape.
+ * @note Any type of collision due to object overlap is handled by calling the
+ * collision_dispatcher.
+ *
+ * @param obj         Object that claims the area of the grid
+ * @param col_grid    The collision grid to update
+ * @param x				    X coordinate of the band's bounding box
+ * @param y				    Y coordinate of the band's bounding box
+ * @param len         Number of squares
+ * @param size        Side of the squares
+ * @param down        Whether the band goes down to the right (or to the left)
+ * @param already_collided_objs Pointer to the set of collided objects.
+ */
+void updateCollisionMatrixBand(void* obj,
+                               Broadphase_t* col_grid,
+                               uint16_t x,
+                               uint16_t y,
+                               uint16_t len,
+                               uint16_t size,
+                               bool down,
+                               Hash_Set_t* already_collided_objs);
 
 /**
- * @brief	Updates the object of an area delimited by a given x, y, height
- * and width (basically a rectangle) of a given collision matrix.
- * Ignores all pixels that are transparent in the given sprite.
- * @note Any type of collision due to object overlab is handled by calling the
+ * @brief	Inserts the area covered by a given sprite of an object into a given
+ * collision grid. Ignores all pixels that are transparent in the given sprite.
+ * @note Any type of collision due to object overlap is handled by calling the
  * collision_dispatcher.
  *
- * @param obj         Object to be refered to in the selected points of the
- *matrix
- * @param col_matrix  The collision matrix to update
- * @param x				    Starting X coordinate of the
- *rectangle to update
- * @param y				    Starting Y coordinate of the
- *rectangle point to update
+ * @param obj         Object that claims the area of the grid
+ * @param col_grid    The collision grid to update
+ * @param x				    Starting X coordinate of the sprite
+ * @param y				    Starting Y coordinate of the sprite
  * @param spr         Sprite of the object to work with (get width and height)
- * @param already_collided_objs Pointer to the vector of collided objects.
+ * @param already_collided_objs Pointer to the set of collided objects.
  */
 void updateCollisionMatrix(void* obj,
-                           vector* col_matrix,
+                           Broadphase_t* col_grid,
                            uint16_t x,
                            uint16_t y,
                            Sprite_t* spr,
-                           vector* already_collided_objs);
+                           Hash_Set_t* already_collided_objs);
 
 /* VIRTUAL FUNCTIONS */
 
@@ -203,7 +242,7 @@ void updatePos(void* obj);
 
 void destroy(void* obj);
 
-void updateCollisions(void* obj, vector* col_matrix);
+void updateCollisions(void* obj, Broadphase_t* col_grid);
 
 /**@}*/
 
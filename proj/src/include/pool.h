@@ -0,0 +1,75 @@
+/** @file pool.h */
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "vector.h"
+
+/** @addtogroup	util_grp
+ * @{
+ */
+
+/** @struct POOL_T
+ *  Pool of fixed-size memory blocks, carved out of bigger slabs.
+ *  Free blocks are kept in a free list (no heap calls in steady state).
+ */
+typedef struct POOL_T
+{
+  size_t block_size;      /**< Size of each block, in bytes. */
+  size_t blocks_per_slab; /**< Number of blocks in each slab. */
+  vector* slabs;          /**< Slabs alloced by the pool. */
+  void* free_list;        /**< First free block (NULL if none). */
+  size_t in_use;          /**< Number of blocks currently handed out. */
+} Pool_t;
+
+/**
+ * @brief Creates a new pool object (the first slab is preallocated).
+ *
+ * @param block_size      Size of each block, in bytes.
+ * @param blocks_per_slab Number of blocks in each slab.
+ *
+ * @return  Pointer to the new pool object, on success\n
+ *          NULL, otherwise.
+ */
+Pool_t* new_pool(size_t block_size, size_t blocks_per_slab);
+
+/**
+ * @brief Free a pool object and all its slabs.
+ * @warning All blocks handed out by the pool become invalid.
+ *
+ * @param pool  Pool to free.
+ */
+void free_pool(Pool_t* pool);
+
+/**
+ * @brief Get a free block from a given pool (a new slab is alloced if the pool
+ * is exhausted).
+ *
+ * @param pool  Pool to get the block from.
+ *
+ * @return  Pointer to the block, on success\n
+ *          NULL, otherwise.
+ */
+void* pool_alloc(Pool_t* pool);
+
+/**
+ * @brief Give a block back to the pool it came from.
+ *
+ * @param pool  Pool the block belongs to.
+ * @param block Block to give back.
+ */
+void pool_free(Pool_t* pool, void* block);
+
+/**
+ * @brief Mark all blocks of a pool as free (slabs are kept alloced).
+ * @warning All blocks handed out by the pool become invalid.
+ *
+ * @param pool  Pool to reset.
+ */
+void pool_reset(Pool_t* pool);
+
+/** @} */
+
+#endif // __POOL_H__
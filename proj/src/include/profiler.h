@@ -0,0 +1,110 @@
+/** @file profiler.h */
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+#include <stdint.h>
+
+/** @addtogroup	util_grp
+ * @{
+ */
+
+/** Number of frames kept by the profiler (the older ones are overwritten) */
+#define PROF_FRAMES 512
+/** Binary trace file written when the program exits */
+#define PROF_TRACE_FILE "/tmp/skane_prof.bin"
+/** Magic number at the start of the binary trace file ("SKPF") */
+#define PROF_TRACE_MAGIC 0x46504B53
+
+/** @enum prof_phase_t
+ *  Timed phases of a game frame */
+typedef enum prof_phase_t {
+  PROF_UPDATE,     /**< Whole frame update */
+  PROF_CLEAR,      /**< Clear the collision grid */
+  PROF_COLLISIONS, /**< Collision detection and handling */
+  PROF_POSITIONS,  /**< Calculate the objects' positions */
+  PROF_RENDER,     /**< Draw the objects */
+  PROF_FLIP,       /**< Switch the frame buffers */
+  PROF_GC,         /**< Cull the dead objects */
+  PROF_NUM_PHASES  /**< Number of timed phases */
+} prof_phase;
+
+/** @struct PROF_TRACE_HEADER_T
+ *  Header of the binary trace file. It is followed by num_frames records of
+ * num_phases uint32_t each (TSC cycles spent in each phase), oldest first. */
+typedef struct PROF_TRACE_HEADER_T
+{
+  uint32_t magic;      /**< PROF_TRACE_MAGIC. */
+  uint32_t num_phases; /**< Number of phases in each record. */
+  uint32_t num_frames; /**< Number of records in the file. */
+  uint32_t first;      /**< Number of the frame in the first record. */
+  uint64_t tsc_hz;     /**< Estimated TSC frequency (cycles per second). */
+} Prof_Trace_Header_t;
+
+#ifdef PROFILE
+/** Start the profiler (reported/dumped when the program exits) */
+#define PROF_INIT() prof_init()
+/** Start timing a phase */
+#define PROF_BEGIN(phase) prof_begin(phase)
+/** Stop timing a phase */
+#define PROF_END(phase) prof_end(phase)
+/** Time a single statement */
+#define PROF_SCOPE(phase, stmt) \
+  do {                          \
+    prof_begin(phase);          \
+    stmt;                       \
+    prof_end(phase);            \
+  } while (0)
+/** Save the times of the current frame */
+#define PROF_END_FRAME() prof_end_frame()
+#else
+#define PROF_INIT()             ((void)0)
+#define PROF_BEGIN(phase)       ((void)0)
+#define PROF_END(phase)         ((void)0)
+#define PROF_SCOPE(phase, stmt) stmt
+#define PROF_END_FRAME()        ((void)0)
+#endif
+
+/**
+ * @brief Starts the profiler. The report (see prof_report()) and the binary
+ * trace (see prof_dump_trace()) are written when the program exits.
+ * @note Use the PROF_* macros instead, they are compiled out unless PROFILE
+ * is defined.
+ */
+void prof_init(void);
+
+/**
+ * @brief Starts timing a phase of the current frame.
+ *
+ * @param phase Phase to time.
+ */
+void prof_begin(prof_phase phase);
+
+/**
+ * @brief Stops timing a phase of the current frame (a phase timed more than
+ * once in a frame accumulates its times).
+ *
+ * @param phase Phase to stop timing.
+ */
+void prof_end(prof_phase phase);
+
+/** @brief Saves the times of the current frame in the ring of frame records
+ * and starts a new one. */
+void prof_end_frame(void);
+
+/** @brief Logs (through warn()) the p50, p99 and max times of each phase over
+ * the saved frames. */
+void prof_report(void);
+
+/**
+ * @brief Writes the saved frame records to a binary trace file.
+ *
+ * @param path  Path of the file to write.
+ *
+ * @return  0, on success\n
+ *          1, otherwise.
+ */
+int prof_dump_trace(const char* path);
+
+/** @} */
+
+#endif // __PROFILER_H__
@@ -10,17 +10,18 @@
  * @{
  */
 
-/** A queue node */
-typedef struct node Node_t;
+/** Number of bytes a queue can hold (must be a power of 2) */
+#define QUEUE_CAPACITY 4096
 
 /** @struct QUEUE_T
- *  A queue object
+ *  A queue object (fixed-capacity ring buffer of bytes)
  */
 typedef struct QUEUE_T
 {
-  Node_t* back;  /** previous node */
-  Node_t* front; /** next node */
-  size_t size;   /** number of nodes in the queue */
+  uint8_t* data;   /**< ring buffer */
+  size_t capacity; /**< size of the ring buffer (power of 2) */
+  size_t back;     /**< free-running position of the next push */
+  size_t front;    /**< free-running position of the next pop */
 } Queue_t;
 
 /**
@@ -40,14 +41,35 @@ Queue_t* new_queue(void);
  */
 bool queue_empty(Queue_t* queue);
 
+/**
+ * @brief Get the number of elements in a given queue.
+ *
+ * @param queue Queue to check.
+ *
+ * @return  Number of elements in the queue.
+ */
+size_t queue_size(Queue_t* queue);
+
 /**
  * @brief Push element into queue.
+ * @warning The element is dropped if the queue is full.
  *
  * @param queue Queue object to push the element into.
- * @param data  Data of the element to push (node with it is created).
+ * @param data  Data of the element to push.
  */
 void queue_push(Queue_t* queue, uint8_t data);
 
+/**
+ * @brief Push a given number of elements into a queue (in order).
+ *
+ * @param queue Queue object to push the elements into.
+ * @param data  Elements to push.
+ * @param n     Number of elements to push.
+ *
+ * @return  Number of elements pushed (less than n if the queue fills up).
+ */
+size_t queue_push_n(Queue_t* queue, const uint8_t* data, size_t n);
+
 /**
  * @brief Pop element from given queue.
  *
@@ -55,12 +77,35 @@ void queue_push(Queue_t* queue, uint8_t data);
  */
 void queue_pop(Queue_t* queue);
 
+/**
+ * @brief Pop a given number of elements from a queue.
+ *
+ * @param queue Queue to pop the elements from.
+ * @param data  Array to copy the popped elements into.
+ * @param n     Number of elements to pop.
+ *
+ * @return  Number of elements popped (less than n if the queue empties).
+ */
+size_t queue_pop_n(Queue_t* queue, uint8_t* data, size_t n);
+
+/**
+ * @brief Copy a given number of elements from the front of a queue, without
+ * popping them.
+ *
+ * @param queue Queue to get the elements from.
+ * @param data  Array to copy the elements into.
+ * @param n     Number of elements to copy.
+ *
+ * @return  Number of elements copied (less than n if the queue is smaller).
+ */
+size_t queue_peek_n(Queue_t* queue, uint8_t* data, size_t n);
+
 /**
  * @brief Get data of the next queue element.
  *
  * @param queue Queue to get the element from.
  *
- * @return The data of the element.
+ * @return The data of the element (0 if the queue is empty).
  */
 uint8_t queue_front(Queue_t* queue);
 
@@ -4,6 +4,8 @@
 
 #include <stdint.h>
 
+#include "deque.h"
+#include "flow_field.h"
 #include "game_opts.h"
 #include "missile.h"
 #include "object.h"
@@ -96,11 +98,12 @@ typedef struct SKANE_T
   /*@{*/
   direc curr_state;      /**< Skane current movement direction */
   direc collision_direc; /**< Skane's collision direction */
-  vector* directions;    /**< Skane's body components */
+  Deque_t* directions;   /**< Skane's body segments (head first) */
   bool changed_direc;    /**< If set, skane changed direction */
   float t_x, t_y;        /**< Skane's current tail position */
   uint8_t fire_cd;       /**< Skane's current shot cooldown */
   enemy_diff* ediff;     /**< Skane's enemies difficulty scaling */
+  Flow_Field_t* flow;    /**< Leads skane's enemies to it (NULL if none) */
   /*@}*/
 
   /** @name Other skane members. */
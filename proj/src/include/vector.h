@@ -147,6 +147,8 @@ void* vector_at(vector* vec, size_t i);
 
 /**
  * @brief Insert element into a given index.
+ * @note  The elements after the index are shifted in place. Inserting at the
+ * end of the vector is the same as a push-back.
  *
  * @param vec   Vector to insert the element into.
  * @param i     Index to insert the element into.
@@ -156,12 +158,35 @@ void vector_insert(vector* vec, size_t i, void* elem);
 
 /**
  * @brief Remove element in a given index.
+ * @note  The elements after the index are shifted in place (order is kept).
  *
  * @param vec Vector to remove the element from.
  * @param i   Index of the element in the vector.
  */
 void vector_delete(vector* vec, size_t i);
 
+/**
+ * @brief   Remove element in a given index, in constant time.
+ * @warning The last element of the vector is moved into the removed element's
+ * place (order isn't kept).
+ *
+ * @param vec Vector to remove the element from.
+ * @param i   Index of the element in the vector.
+ */
+void vector_swap_remove(vector* vec, size_t i);
+
+/**
+ * @brief Remove all the elements for which a given predicate is true, in a
+ * single pass (order is kept).
+ * @warning Doesn't free the removed elements.
+ *
+ * @param vec   Vector to remove the elements from.
+ * @param pred  Predicate called for each element.
+ *
+ * @return  Number of removed elements.
+ */
+size_t vector_remove_if(vector* vec, bool (*pred)(void*));
+
 /** @} */
 
 #endif // __VECTOR_H__
@@ -9,6 +9,29 @@
  * @{
  */
 
+/** @brief	Run of opaque pixels (span) in a sprite row. */
+typedef struct
+{
+  uint16_t Start; /**< @brief Column of the first opaque pixel. */
+  uint16_t Len;   /**< @brief Number of opaque pixels. */
+} Sprite_Span_t;
+
+/** @brief	Opaque spans of a sprite, row by row (built when the sprite is
+ * created). */
+typedef struct
+{
+  uint32_t Transp; /**< @brief Color the spans were built for. */
+  uint32_t Id;     /**< @brief Unique id of the sprite's pixels (never 0). */
+  /**
+   * @brief	Index of the first span of each row (plus one past the last
+   * row).
+   * @details	The spans of row y are Spans[RowStart[y]] up to (excluding)
+   *Spans[RowStart[y + 1]]. Fully transparent rows have no spans.
+   */
+  uint32_t* RowStart;
+  Sprite_Span_t* Spans; /**< @brief Spans of all rows, left to right. */
+} Sprite_Spans_t;
+
 /** @brief	Struct that saves the information of a sprite. */
 typedef struct
 {
@@ -21,6 +44,11 @@ typedef struct
    *depending on the graphics mode at which the read image file was encoded.
    */
   uint8_t* Data;
+  /**
+   * @brief	Opaque spans (NULL if none).
+   * @details	Copies of a sprite share the same spans object.
+   */
+  Sprite_Spans_t* Spans;
 } Sprite_t;
 
 /* VG GETTERS */
@@ -45,6 +73,46 @@ void vg_clear(void);
 /** @brief	Clears all buffers currently alloced by the program. */
 void vg_clear_all(void);
 
+/**@brief	Turns all drawing into no-ops (nothing is written to video
+ *memory and the frame buffers are never switched).
+ *
+ * @param no_draw	Whether to stop drawing.
+ */
+void vg_set_headless(bool no_draw);
+
+/**@brief	Draws the frames to a back buffer in system memory (cached)
+ * instead of VRAM. next_buff() copies the parts that changed to the VRAM page
+ * before showing it, with streaming (non-temporal) stores.
+ * @note	Must be set after vginit() (setting a mode goes back to drawing to
+ * VRAM).
+ *
+ * @param enable	Whether to draw to system memory.
+ *
+ * @return	0, on success\n
+ *		1, otherwise (frames are drawn to VRAM).
+ */
+int vg_set_ram_buff(bool enable);
+
+/**@brief	Starts drawing a static background: until vg_bkg_end(),
+ * draw_sprite_i() and draw_rect_i() draw to an image in system memory (cleared
+ * first), that is restored wherever a frame is redrawn (instead of clearing
+ * it).
+ * @note	Meant for what never changes (e.g.: the map). It costs the same
+ *whatever is drawn to it.
+ *
+ * @return	0, on success\n
+ *		1, otherwise (nothing is drawn to the background).
+ */
+int vg_bkg_begin(void);
+
+/**@brief	Stops drawing the static background (see vg_bkg_begin()). The
+ * next frames show it. */
+void vg_bkg_end(void);
+
+/**@brief	Frees the static background (the frames are cleared to black
+ * again). */
+void vg_bkg_free(void);
+
 /**@brief	Set true color mode for the currently set video graphics mode.
  * @return	0, on success\n
  *		1, otherwise.
@@ -81,6 +149,9 @@ int set_random_color_palette(uint8_t palette_size, uint8_t first_color_ind);
 
 /* OTHER PUBLIC FUNCTIONS */
 /** @brief	Switchs to next frame buffer (in case there is more than one).
+ * @details	The frame recorded by draw_sprite_i() and draw_rect_i() is drawn
+ * first: only the areas that changed since the back buffer was last drawn are
+ * cleared and redrawn.
  */
 void next_buff(void);
 /**@brief	Sets the super VGA graphics mode to a given mode.
@@ -190,6 +261,7 @@ void draw_sprite_ovr(Sprite_t* sprite,
 /**@brief	Draw a rectangle on the current video memory buffer.
  * @note	All distances are measured in pixels. Optimized version for
  * packed pixel modes only.
+ * @note	The rectangle is only recorded: it is drawn by next_buff().
  *
  * @param x		x coordinate of the top-left rectangle corner.
  * @param y		y coordinate of the top-left rectangle corner.
@@ -203,6 +275,31 @@ void draw_rect_i(uint16_t x,
                  uint16_t height,
                  uint8_t color);
 
+/** Draw 45 degree band (indexed mode only) function like macro */
+#define DRAW_BAND(x, y, l, s, d, c) draw_band_i(x, y, l, s, d, (uint8_t)c)
+
+/**@brief	Draw a 45 degree band of squares on the current video memory
+ * buffer: square i is offset by i pixels down and i pixels right (down is true)
+ * or left (down is false) from the first one.
+ * @note	All distances are measured in pixels. Each covered pixel is only
+ * drawn once (one span per line). Optimized version for packed pixel modes
+ * only.
+ * @note	The band is only recorded: it is drawn by next_buff().
+ *
+ * @param x		x coordinate of the band's bounding box top-left corner.
+ * @param y		y coordinate of the band's bounding box top-left corner.
+ * @param len		Number of squares.
+ * @param size		Side of the squares.
+ * @param down		Whether the band goes down to the right (or to the left).
+ * @param color		Color of the band.
+ */
+void draw_band_i(uint16_t x,
+                 uint16_t y,
+                 uint16_t len,
+                 uint16_t size,
+                 bool down,
+                 uint8_t color);
+
 /** Draw sprite (indexed mode only) function like macro */
 #define DRAW_SPRITE(s, x, y, t) draw_sprite_i(s, x, y, (uint8_t)t)
 
@@ -210,6 +307,8 @@ void draw_rect_i(uint16_t x,
  * (skipping transparent pixels).
  * @note	Uses double buffering. Optimized version for packed pixel modes
  * only.
+ * @note	The sprite is only recorded: it is drawn by next_buff() (its
+ * pixels must still exist by then).
  *
  * @param sprite	Sprite to copy the information from.
  * @param x		Number of pixels from the left margin at which the copy
@@ -9,7 +9,7 @@
  * @{
  */
 
-#pragma pack(1)
+#pragma pack(push, 1)
 /** @struct VBEINFOBLOCK_T
  * Struct used to read and store a graphics controller info. */
 typedef struct VBEINFOBLOCK_T
@@ -27,7 +27,7 @@ typedef struct VBEINFOBLOCK_T
   uint8_t Reserved[222];        /**< @brief	db - 222 dup (?) */
   uint8_t OemData[256];         /**< @brief	db - 256 dup (?) */
 } VbeInfoBlock_t;
-#pragma options align = reset
+#pragma pack(pop)
 
 /**
  * @brief	Give the application privileges over a selected low memory
@@ -1,8 +1,10 @@
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 #include "include/err_utils.h"
 #include "include/missile.h"
+#include "include/obj_handle.h"
 #include "include/object.h"
 
 /* VIRTUAL FUNCTIONS */
@@ -17,9 +19,7 @@ printMissle(void* mis)
 static void
 updateMisslePos(void* mis)
 {
-  Missle_t* m = (Missle_t*)mis;
-
-  m->obj->vtable->updatePos(m->obj);
+  update_missles(&mis, 1);
 }
 
 static void
@@ -32,16 +32,43 @@ renderMissle(void* mis)
 static void
 destroyMissle(void* mis)
 {
-  Missle_t* m = (Missle_t*)mis;
-  m->obj->vtable->destroy(m->obj);
-  free(m);
+  /* the sprite belongs to the skane that shot the missle */
+  obj_pool_free(MISSILE, mis);
 }
 
 static void
-updateCollisionMissle(void* mis, vector* col_matrix)
+updateCollisionMissle(void* mis, Broadphase_t* col_grid)
 {
   Missle_t* m = (Missle_t*)mis;
-  m->obj->vtable->updateCollision(m, col_matrix);
+  Object_t* o = m->obj;
+
+  /* sweep the sprite from the last position to the new one, in steps no
+   * longer than the sprite itself (consecutive samples touch or overlap, so
+   * nothing is skipped). The samples go in order: the first hit wins. */
+  float del_x = o->x - m->prev_x, del_y = o->y - m->prev_y;
+  float steps_x = fabsf(del_x) / (o->sprite.Width ? o->sprite.Width : 1);
+  float steps_y = fabsf(del_y) / (o->sprite.Height ? o->sprite.Height : 1);
+  size_t steps  = ceilf(steps_x > steps_y ? steps_x : steps_y);
+  if (!steps)
+    steps = 1;
+
+  Hash_Set_t* collided_objs = new_hash_set(frame_arena());
+  if (!collided_objs) {
+    warn("%s: Not enough memory to check the collisions", __func__);
+    return;
+  }
+
+  for (size_t i = 1; i < steps && o->identifier.id; ++i)
+    updateCollisionMatrix(m,
+                          col_grid,
+                          m->prev_x + del_x * i / steps,
+                          m->prev_y + del_y * i / steps,
+                          &o->sprite,
+                          collided_objs);
+
+  /* the last sample is the new position itself */
+  if (o->identifier.id)
+    updateCollisionMatrix(m, col_grid, o->x, o->y, &o->sprite, collided_objs);
 }
 
 const static Object_Vtable_t missle_vtable = { .draw      = renderMissle,
@@ -59,28 +86,44 @@ new_missle(float speed_x,
            float y,
            Sprite_t* sprite,
            uint16_t damage,
-           uint8_t my_ska)
+           uint32_t my_ska)
 {
-  Missle_t* missle = malloc(sizeof(Missle_t));
+  Missle_t* missle = (Missle_t*)obj_pool_alloc(MISSILE);
   if (!missle)
     return NULL;
 
-  Object_t* obj = new_object(speed_x, speed_y, x, y, sprite);
-  if (!obj) {
-    free(missle);
-    return NULL;
-  }
+  /* the base object lives right after the missle in the pooled block */
+  Object_t* obj = (Object_t*)(missle + 1);
+  init_object(obj, speed_x, speed_y, x, y, sprite);
   missle->obj = obj;
 
   missle->vtable = &missle_vtable;
 
   missle->damage = damage;
   missle->my_ska = my_ska;
+  missle->prev_x = x;
+  missle->prev_y = y; // nothing swept yet
 
-  static size_t curr_id        = 1;
-  missle->obj->identifier.id   = curr_id;
+  missle->obj->identifier.id   = new_obj_id(missle);
   missle->obj->identifier.type = MISSILE;
-  ++curr_id;
+  if (!missle->obj->identifier.id) {
+    obj_pool_free(MISSILE, missle);
+    return NULL;
+  }
 
   return missle;
 }
+
+void
+update_missles(void** missles, size_t n)
+{
+  for (size_t i = 0; i < n; ++i) {
+    Missle_t* m = (Missle_t*)missles[i];
+    Object_t* o = m->obj;
+
+    m->prev_x = o->x;
+    m->prev_y = o->y; // start of the path swept this frame
+    o->x += o->speed_x;
+    o->y += o->speed_y;
+  }
+}
@@ -3,12 +3,17 @@
 #include <string.h>
 
 #include "include/bmp.h"
+#include "include/broadphase.h"
 #include "include/collisions.h"
 #include "include/cursor.h"
 #include "include/enemies.h"
 #include "include/err_utils.h"
+#include "include/flow_field.h"
+#include "include/food.h"
+#include "include/handle.h"
 #include "include/obj_handle.h"
 #include "include/object.h"
+#include "include/pool.h"
 #include "include/serial.h"
 #include "include/skane.h"
 #include "include/vector.h"
@@ -23,30 +28,91 @@ static Cursor_t* c;
 static Menu_t *start_sing_menu, *start_mult_menu, *exit_menu, *title_menu,
   *loading_menu;
 static vector* objs;
-static vector* collision_matrix;
-char respath[PATH_MAXSIZE];
+static Handle_Table_t obj_ids; // ids (handles) of the game objects
+static Broadphase_t* collision_grid;
+static Pool_t* obj_pools[NUM_LAYERS]; // only pooled types have a pool
+static bool walls_in_bkg;  // the WALL layer is drawn to the static background
+static bool walls_in_grid; // the WALL layer is in the static collision layer
 
 /* OBJECT FUNCTIONS */
+static void
+draw_interpolated(void* obj, float lag)
+{
+  Object_t* o = ((Derived_obj_t*)obj)->obj;
+  float x = o->x, y = o->y;
+
+  /* draw the object lag steps back on its way, and put it back */
+  o->x -= (x - o->prev_x) * lag;
+  o->y -= (y - o->prev_y) * lag;
+  draw(obj);
+  o->x = x;
+  o->y = y;
+}
+
 void
-render_objects(void)
+render_objects(float lag)
 {
   /* Iterate through layers */
   for (size_t i = 0; i < objs->end; ++i) {
     /* iterate through objects in a layer */
+    if (i == WALL && walls_in_bkg)
+      continue; // already on screen
+
     vector* curr_vec = (vector*)vector_at(objs, i);
-    for (size_t j = 0; j < curr_vec->end; ++j)
-      draw(vector_at(curr_vec, j));
+    for (size_t j = 0; j < curr_vec->end; ++j) {
+      if (lag)
+        draw_interpolated(vector_at(curr_vec, j), lag);
+      else
+        draw(vector_at(curr_vec, j));
+    }
   }
 
   draw(c);
 }
 
+void
+save_objs_pos(void)
+{
+  for (size_t i = 0; i < objs->end; ++i) {
+    if (i == WALL)
+      continue; // walls never move
+
+    vector* curr_vec = (vector*)vector_at(objs, i);
+    for (size_t j = 0; j < curr_vec->end; ++j) {
+      Object_t* o = ((Derived_obj_t*)vector_at(curr_vec, j))->obj;
+      o->prev_x   = o->x;
+      o->prev_y   = o->y;
+    }
+  }
+}
+
+static void
+update_none(void** layer_objs, size_t n)
+{
+  (void)layer_objs;
+  (void)n; // the objects of this layer never move
+}
+
+/* batched position updates of each layer (NULL: the objects of the layer are
+ * updated one by one through their vtable) */
+static void (*const layer_updates[NUM_LAYERS])(void**, size_t) = {
+  [WALL]    = update_none,
+  [FOOD]    = update_none,
+  [ENEMY]   = update_enemies,
+  [MISSILE] = update_missles,
+};
+
 void
 calc_objs_pos(void)
 {
   /* Iterate through layers */
   for (size_t i = 0; i < objs->end; ++i) {
     vector* curr_vec = (vector*)vector_at(objs, i);
+    if (layer_updates[i]) {
+      layer_updates[i](curr_vec->data, curr_vec->end);
+      continue;
+    }
+
     /* iterate through objects in a layer */
     for (size_t j = 0; j < curr_vec->end; ++j)
       updatePos(vector_at(curr_vec, j));
@@ -56,8 +122,8 @@ calc_objs_pos(void)
 void
 clear_collision_matrix(void)
 {
-  for (size_t i = 0; i < collision_matrix->end; ++i)
-    vector_clear(vector_at(collision_matrix, i));
+  if (collision_grid)
+    broadphase_clear(collision_grid);
 }
 
 void
@@ -65,10 +131,13 @@ update_objs_collisions(void)
 {
   /* Iterate through layers until skane body */
   for (size_t i = 0; i < SKANE; ++i) {
+    if (i == WALL && walls_in_grid)
+      continue; // already in the grid
+
     vector* curr_vec = (vector*)vector_at(objs, i);
     /* iterate through objects in a layer */
     for (size_t j = 0; j < curr_vec->end; ++j) {
-      updateCollisions(vector_at(curr_vec, j), collision_matrix);
+      updateCollisions(vector_at(curr_vec, j), collision_grid);
     }
   }
 
@@ -77,32 +146,49 @@ update_objs_collisions(void)
     vector* curr_vec = (vector*)vector_at(objs, i);
     /* iterate through objects in a layer */
     for (size_t j = 0; j < curr_vec->end; ++j)
-      updateCollisions(vector_at(curr_vec, j), collision_matrix);
+      updateCollisions(vector_at(curr_vec, j), collision_grid);
   }
 
   /* Update skane body last (object of lesser importance collision-wise) */
   vector* curr_vec = (vector*)vector_at(objs, SKANE);
   /* iterate through objects in a layer */
   for (size_t j = 0; j < curr_vec->end; ++j)
-    updateCollisions(vector_at(curr_vec, j), collision_matrix);
+    updateCollisions(vector_at(curr_vec, j), collision_grid);
 }
 
 void
 debug_collisions(void)
 {
   static int cl = 0;
-  for (size_t i = 0; i < collision_matrix->size; ++i) {
-    vector* vec = (vector*)vector_at(collision_matrix, i);
-    for (size_t j = 0; j < vec->end; ++j) {
-      if (vector_at(vec, j) != NULL)
-        draw_line(j, i, cl, 1);
-    }
+  for (size_t i = 0; i < collision_grid->entries_end; ++i) {
+    Broadphase_Entry_t* e = &collision_grid->entries[i];
+    draw_rect(e->x, e->y, e->w, e->h, cl);
+  }
+  for (size_t i = 0; i < collision_grid->static_end; ++i) {
+    Broadphase_Entry_t* e = &collision_grid->static_entries[i];
+    draw_rect(e->x, e->y, e->w, e->h, cl);
   }
   ++cl;
   if (cl > 10)
     cl = 0;
 }
 
+static bool
+is_dead(void* obj)
+{
+  return ((Derived_obj_t*)obj)->obj->identifier.id == 0;
+}
+
+static bool
+destroy_if_dead(void* obj)
+{
+  if (!is_dead(obj))
+    return false;
+
+  destroy(obj);
+  return true;
+}
+
 int
 garbage_collector(void)
 {
@@ -118,16 +204,10 @@ garbage_collector(void)
     return 1;
   }
 
-  for (size_t i = 0; i < objs->end; ++i) {
-    vector* curr_vec = (vector*)vector_at(objs, i);
-    for (size_t j = 0; j < curr_vec->end; ++j) {
-      Derived_obj_t* d_obj = (Derived_obj_t*)vector_at(curr_vec, j);
-      if (d_obj->obj->identifier.id == 0) {
-        vector_delete(curr_vec, j);
-        --j;
-      }
-    }
-  }
+  /* dead pooled objects go back to their pool, the others are only culled */
+  for (size_t i = 0; i < objs->end; ++i)
+    vector_remove_if((vector*)vector_at(objs, i),
+                     obj_pools[i] ? destroy_if_dead : is_dead);
 
   return 0;
 }
@@ -145,17 +225,30 @@ add_object(void* object_to_be_added, int layer)
 }
 
 void
-remove_object(int object_id, int object_type)
-{
-  vector* vec = vector_at(objs, object_type);
-  for (size_t i = 0; i < vec->end; i++) {
-    void* object = (vector_at(vec, i));
-    if (((Derived_obj_t*)object)->obj->identifier.id == object_id) {
-      vector_delete(vec, i);
-      destroy(object);
-      return;
-    }
-  }
+remove_object(uint32_t object_id)
+{
+  Derived_obj_t* object = (Derived_obj_t*)get_obj(object_id);
+  if (object)
+    kill_object(object->obj);
+}
+
+uint32_t
+new_obj_id(void* object)
+{
+  return handle_new(&obj_ids, object);
+}
+
+void*
+get_obj(uint32_t object_id)
+{
+  return handle_get(&obj_ids, object_id);
+}
+
+void
+kill_object(Object_t* obj)
+{
+  handle_free(&obj_ids, obj->identifier.id);
+  obj->identifier.id = 0;
 }
 
 void
@@ -169,15 +262,41 @@ destroy_all_objects(void)
       ska2 = NULL;
     }
   }
+  /* the walls will be gone */
+  vg_bkg_free();
+  walls_in_bkg = false;
+  if (collision_grid)
+    broadphase_static_clear(collision_grid);
+  walls_in_grid = false;
+
   /* free nested vectors and destroy all their objects */
   for (size_t i = 0; i < objs->end; ++i) {
     vector* curr_vec = (vector*)vector_at(objs, i);
-    for (size_t j = 0; j < curr_vec->end; ++j) {
-      destroy(vector_at(curr_vec, j));
+    if (obj_pools[i]) // pooled objects are all freed at once
+      pool_reset(obj_pools[i]);
+    else if (i != SKANE) { // skanes were already destroyed
+      for (size_t j = 0; j < curr_vec->end; ++j) {
+        Object_t* obj = ((Derived_obj_t*)vector_at(curr_vec, j))->obj;
+        /* objects can share a sprite (e.g.: walls): only the last one frees it */
+        for (size_t k = j + 1; k < curr_vec->end; ++k) {
+          if (((Derived_obj_t*)vector_at(curr_vec, k))->obj->sprite.Data ==
+              obj->sprite.Data) {
+            memset(&obj->sprite, 0, sizeof(Sprite_t));
+            break;
+          }
+        }
+        destroy(vector_at(curr_vec, j));
+      }
     }
-    free_vector(curr_vec);
+    /* the objects were already destroyed (only free the vectors) */
+    free(curr_vec->data);
+    free(curr_vec);
   }
-  free_vector(objs);
+  free(objs->data);
+  free(objs);
+
+  /* the ids of the destroyed objects become stale */
+  handle_table_reset(&obj_ids);
 }
 
 void
@@ -195,24 +314,59 @@ alloc_obj_matrix(void)
 void
 alloc_collison_matrix(void)
 {
-  /* allocate collision matrix */
-  collision_matrix = new_vector();
-  if (vector_reserve(collision_matrix, get_v_res()) != get_v_res())
-    die("Not enough memory to allocate collision matrix");
+  /* allocate collision grid (cells the size of a skane's body) */
+  free_broadphase(collision_grid);
+  collision_grid = new_broadphase(get_h_res(), get_v_res(), DFLT_C_SIZE);
+  if (!collision_grid)
+    die("Not enough memory to allocate collision grid");
+}
 
-  unsigned h_res = get_h_res();
-  for (size_t i = get_v_res(); i; --i) {
-    vector* new_col_vec = new_vector();
-    if (vector_reserve(new_col_vec, h_res) != h_res)
-      die("Not enough memory to allocate collision matrix");
+void
+alloc_obj_pools(void)
+{
+  /* pooled blocks hold the derived object followed by its base object */
+  static const size_t block_sizes[NUM_LAYERS] = {
+    [MISSILE] = sizeof(Missle_t) + sizeof(Object_t),
+    [ENEMY]   = sizeof(Enemy_t) + sizeof(Object_t),
+    [FOOD]    = sizeof(Food_t) + sizeof(Object_t),
+  };
+  static const size_t pool_sizes[NUM_LAYERS] = {
+    [MISSILE] = MIS_POOL_SIZE,
+    [ENEMY]   = ENE_POOL_SIZE,
+    [FOOD]    = FOOD_POOL_SIZE,
+  };
 
-    for (size_t j = h_res; j; --j)
-      vector_push_back(new_col_vec, NULL);
+  for (size_t i = 0; i < NUM_LAYERS; ++i) {
+    if (!block_sizes[i])
+      continue;
 
-    vector_push_back(collision_matrix, new_col_vec);
+    if (obj_pools[i])
+      pool_reset(obj_pools[i]);
+    else if (!(obj_pools[i] = new_pool(block_sizes[i], pool_sizes[i])))
+      die("Not enough memory to allocate the object pools");
   }
 }
 
+void*
+obj_pool_alloc(obj_type type)
+{
+  if (type >= NUM_LAYERS || !obj_pools[type]) {
+    warn("%s: Objects of type %d aren't pooled", __func__, type);
+    return NULL;
+  }
+
+  return pool_alloc(obj_pools[type]);
+}
+
+void
+obj_pool_free(obj_type type, void* block)
+{
+  if (type >= NUM_LAYERS || !obj_pools[type])
+    return;
+
+  pool_free(obj_pools[type], block);
+}
+
 /* MENUS */
 void
 delete_menus(void)
@@ -233,6 +387,10 @@ delete_menus(void)
     destroy(loading_menu);
     loading_menu = NULL;
   }
+  if (title_menu) {
+    destroy(title_menu);
+    title_menu = NULL;
+  }
 }
 
 void
@@ -517,6 +675,44 @@ spawn_allies(uint8_t grp_size, gamestate gamest)
   }
 }
 
+static Flow_Field_t*
+new_map_flow_field(void)
+{
+  Flow_Field_t* ff = new_flow_field(get_h_res(), get_v_res(), DFLT_C_SIZE);
+  if (!ff)
+    return NULL;
+
+  /* block the cells of the walls that stop enemies (not the spawners) */
+  vector* walls = (vector*)vector_at(objs, WALL);
+  for (size_t i = 0; i < walls->end; ++i) {
+    Wall_t* w = (Wall_t*)vector_at(walls, i);
+    if (w->type == HORIZ_WALL || w->type == VERT_WALL)
+      flow_field_block(ff,
+                       w->obj->x,
+                       w->obj->y,
+                       w->length * w->obj->sprite.Width,
+                       w->height * w->obj->sprite.Height);
+  }
+
+  return ff;
+}
+
+static void
+inst_flow_fields(void)
+{
+  /* each skane leads its own enemies (its field is only computed while it has
+   * enemies chasing it) */
+  Skane_t* skanes[] = { ska, ska2 };
+  for (size_t i = 0; i < sizeof(skanes) / sizeof(skanes[0]); ++i) {
+    if (!skanes[i])
+      continue;
+
+    free_flow_field(skanes[i]->flow);
+    if (!(skanes[i]->flow = new_map_flow_field()))
+      warn("%s: Enemies will chase their skane in a straight line", __func__);
+  }
+}
+
 void
 create_map(gamestate gamest)
 {
@@ -561,6 +757,7 @@ create_map(gamestate gamest)
                v_w_spr,
                VERT_WALL);
   add_object(w, WALL);
+  free(v_w_spr); // the walls keep a copy of the sprite
 
   /* border corners */
   w = new_wall(0, 0, 1, 1, &c_w_spr, VERT_WALL);
@@ -609,6 +806,25 @@ create_map(gamestate gamest)
 
   /* w = new_wall(200, 200, 1, 20, v_w_spr, VERT_WALL); */
   /* add_object(w, WALL); */
+
+  /* walls never move (nor change): draw them once, to the static background */
+  if (!vg_bkg_begin()) {
+    vector* walls = (vector*)vector_at(objs, WALL);
+    for (size_t i = 0; i < walls->end; ++i)
+      draw(vector_at(walls, i));
+    vg_bkg_end();
+    walls_in_bkg = true;
+  }
+
+  /* nor collide with each other: bake them to the static collision layer, that
+   * the other objects query without the walls being inserted every frame */
+  vector* walls = (vector*)vector_at(objs, WALL);
+  broadphase_static_begin(collision_grid);
+  for (size_t i = 0; i < walls->end; ++i)
+    updateCollisions(vector_at(walls, i), collision_grid);
+  walls_in_grid = !broadphase_static_end(collision_grid);
+
+  inst_flow_fields();
 }
 
 /* GETTERS/SETTERS */
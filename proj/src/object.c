@@ -1,7 +1,8 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-#include "include/collisions.h"
+#include "include/bmp.h"
 #include "include/err_utils.h"
 #include "include/object.h"
 #include "include/vg.h"
@@ -13,7 +14,7 @@ static void
 printObject(void* obj)
 {
   Object_t* object = (Object_t*)obj;
-  warn("Object_id: %d Object_type: %d : %.2f : %.2f : %.2f : %.2f",
+  warn("Object_id: %u Object_type: %d : %.2f : %.2f : %.2f : %.2f",
        object->identifier.id,
        object->identifier.type,
        object->speed_x,
@@ -42,7 +43,7 @@ static void
 destroyObj(void* obj)
 {
   Object_t* o = (Object_t*)obj;
-  free(o->sprite.Data);
+  free_sprite(&o->sprite);
   free(o);
 }
 
@@ -52,14 +53,19 @@ destroyObj(void* obj)
  * pointer to the entire derived class must be passed instead of
  * the pointer to the base class */
 static void
-updateCollisionObj(void* obj, vector* col_matrix)
+updateCollisionObj(void* obj, Broadphase_t* col_grid)
 {
   Derived_obj_t* deriv_obj = (Derived_obj_t*)obj;
   Object_t* base_o         = deriv_obj->obj;
 
-  vector* collided_objs = new_vector();
+  Hash_Set_t* collided_objs = new_hash_set(frame_arena());
+  if (!collided_objs) {
+    warn("%s: Not enough memory to check the collisions", __func__);
+    return;
+  }
+
   updateCollisionMatrix(
-    obj, col_matrix, base_o->x, base_o->y, &base_o->sprite, collided_objs);
+    obj, col_grid, base_o->x, base_o->y, &base_o->sprite, collided_objs);
 }
 
 const static Object_Vtable_t object_vtable = { .draw      = renderObject,
@@ -77,120 +83,79 @@ new_object(float speed_x, float speed_y, float x, float y, Sprite_t* sprite)
   if (!obj)
     return NULL;
 
+  init_object(obj, speed_x, speed_y, x, y, sprite);
+  return obj;
+}
+
+void
+init_object(Object_t* obj,
+            float speed_x,
+            float speed_y,
+            float x,
+            float y,
+            Sprite_t* sprite)
+{
   obj->anim_cnt     = 0;
   obj->speed_x      = speed_x;
   obj->speed_y      = speed_y;
   obj->x            = x;
   obj->y            = y;
+  obj->prev_x       = x;
+  obj->prev_y       = y;
   obj->transparency = DFLT_TRANSP;
   if (sprite != NULL)
     obj->sprite = *sprite;
+  else
+    memset(&obj->sprite, 0, sizeof(Sprite_t));
 
   obj->identifier.id   = 0;
   obj->identifier.type = NOT_SET;
   obj->vtable          = &object_vtable;
-  return obj;
 }
 
 void
 updateCollisionMatrix(void* obj,
-                      vector* col_matrix,
+                      Broadphase_t* col_grid,
                       uint16_t x,
                       uint16_t y,
                       Sprite_t* spr,
-                      vector* already_collided_objs)
+                      Hash_Set_t* already_collided_objs)
 {
-  uint16_t v_size = col_matrix->end;
-  uint16_t h_size = ((vector*)(vector_at(col_matrix, 0)))->end;
-
-  if (x > h_size || y > v_size || x < 0 || y < 0)
-    return;
-
-  /* Initialize borders */
-  size_t v_lim; // part of the image that isn't drawn (is out of screen v_res),
-                // if any
-  if ((v_lim = v_size - y) > spr->Height)
-    v_lim = spr->Height;
-
-  size_t h_lim; // part of the image that isn't drawn (is out of screen h_res),
-                // if any
-  if ((h_lim = h_size - x) > spr->Width)
-    h_lim = spr->Width;
-
-  size_t curr_line = y;
-  /* Initalize Sprite Vars */
-  uint8_t* sprite_ptr    = spr->Data; // get sprite data location
-  size_t sprite_ptr_skip = (spr->Width - h_lim) * get_bytespixel();
-
-  for (size_t i = 0; i < v_lim; ++i, ++curr_line) {
-    vector* curr_vec  = vector_at(col_matrix, curr_line);
-    size_t curr_index = x;
-
-    for (size_t j = 0; j < h_lim; ++j, ++curr_index) {
-      void* curr_obj = vector_at(curr_vec, curr_index);
-      if (*sprite_ptr != DFLT_TRANSP) {
-        if (curr_obj == NULL) // No object on current position
-          vector_set(curr_vec, curr_index, obj);
-        else // Collision
-        {
-          if (!vector_contains(already_collided_objs, curr_obj)) {
-            collision_dispatcher(obj, curr_obj);
-            vector_push_back(already_collided_objs, curr_obj);
-          }
-        }
-      }
-      sprite_ptr += get_bytespixel();
-    }
-    sprite_ptr += sprite_ptr_skip;
-  }
+  broadphase_insert(col_grid,
+                    obj,
+                    x,
+                    y,
+                    spr->Width,
+                    spr->Height,
+                    spr,
+                    already_collided_objs);
 }
 
 void
 updateCollisionMatrixRect(void* obj,
-                          vector* col_matrix,
+                          Broadphase_t* col_grid,
                           uint16_t x,
                           uint16_t y,
-                          uint16_t height,
                           uint16_t width,
-                          vector* already_collided_objs)
+                          uint16_t height,
+                          Hash_Set_t* already_collided_objs)
 {
-  uint16_t v_size = col_matrix->end;
-  uint16_t h_size = ((vector*)(vector_at(col_matrix, 0)))->end;
-
-  if (x > h_size || y > v_size || x < 0 || y < 0)
-    return;
+  broadphase_insert(
+    col_grid, obj, x, y, width, height, NULL, already_collided_objs);
+}
 
-  /* Initialize borders */
-  size_t v_lim; // part of the image that isn't drawn (is out of screen v_res),
-                // if any
-  if ((v_lim = v_size - y) > width)
-    v_lim = width;
-
-  size_t h_lim; // part of the image that isn't drawn (is out of screen h_res),
-                // if any
-  if ((h_lim = h_size - x) > height)
-    h_lim = height;
-
-  size_t curr_line = y;
-  /* Initalize Sprite Vars */
-
-  for (size_t i = 0; i < v_lim; ++i, ++curr_line) {
-    vector* curr_vec  = vector_at(col_matrix, curr_line);
-    size_t curr_index = x;
-
-    for (size_t j = 0; j < h_lim; ++j, ++curr_index) {
-      void* curr_obj = vector_at(curr_vec, curr_index);
-      if (curr_obj == NULL) // No object on current position
-        vector_set(curr_vec, curr_index, obj);
-      else if (curr_obj != obj) // Collision
-      {
-        if (!vector_contains(already_collided_objs, curr_obj)) {
-          collision_dispatcher(obj, curr_obj);
-          vector_push_back(already_collided_objs, curr_obj);
-        }
-      }
-    }
-  }
+void
+updateCollisionMatrixBand(void* obj,
+                          Broadphase_t* col_grid,
+                          uint16_t x,
+                          uint16_t y,
+                          uint16_t len,
+                          uint16_t size,
+                          bool down,
+                          Hash_Set_t* already_collided_objs)
+{
+  broadphase_insert_band(
+    col_grid, obj, x, y, len, size, down, already_collided_objs);
 }
 
 /* VIRTUAL FUNCTIONS WRAPPERS */
@@ -222,7 +187,7 @@ destroy(void* obj)
 }
 
 void
-updateCollisions(void* obj, vector* col_matrix)
+updateCollisions(void* obj, Broadphase_t* col_grid)
 {
-  ((Derived_obj_t*)obj)->vtable->updateCollision(obj, col_matrix);
+  ((Derived_obj_t*)obj)->vtable->updateCollision(obj, col_grid);
 }
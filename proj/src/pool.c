@@ -0,0 +1,105 @@
+#include <stdlib.h>
+
+#include "include/pool.h"
+
+/* PRIVATE */
+/* free blocks store the pointer to the next free block in their first bytes */
+static inline void
+pool_push_free(Pool_t* pool, void* block)
+{
+  *(void**)block  = pool->free_list;
+  pool->free_list = block;
+}
+
+static void
+pool_thread_slab(Pool_t* pool, char* slab)
+{
+  /* push in reverse so blocks are handed out in memory order */
+  for (size_t i = pool->blocks_per_slab; i; --i)
+    pool_push_free(pool, slab + (i - 1) * pool->block_size);
+}
+
+static int
+pool_grow(Pool_t* pool)
+{
+  char* slab = (char*)malloc(pool->block_size * pool->blocks_per_slab);
+  if (!slab)
+    return 1;
+
+  vector_push_back(pool->slabs, slab);
+  pool_thread_slab(pool, slab);
+  return 0;
+}
+
+/* PUBLIC */
+Pool_t*
+new_pool(size_t block_size, size_t blocks_per_slab)
+{
+  if (!blocks_per_slab)
+    return NULL;
+
+  Pool_t* pool = (Pool_t*)malloc(sizeof(Pool_t));
+  if (!pool)
+    return NULL;
+
+  /* blocks must be able to hold a pointer and keep it aligned */
+  if (block_size < sizeof(void*))
+    block_size = sizeof(void*);
+  block_size = (block_size + sizeof(void*) - 1) / sizeof(void*) * sizeof(void*);
+
+  pool->block_size      = block_size;
+  pool->blocks_per_slab = blocks_per_slab;
+  pool->free_list       = NULL;
+  pool->in_use          = 0;
+  pool->slabs           = new_vector();
+  if (!pool->slabs || pool_grow(pool)) {
+    free_pool(pool);
+    return NULL;
+  }
+
+  return pool;
+}
+
+void
+free_pool(Pool_t* pool)
+{
+  if (!pool)
+    return;
+
+  if (pool->slabs)
+    free_vector(pool->slabs); // frees the slabs too
+  free(pool);
+}
+
+void*
+pool_alloc(Pool_t* pool)
+{
+  if (!pool->free_list && pool_grow(pool))
+    return NULL;
+
+  void* block     = pool->free_list;
+  pool->free_list = *(void**)block;
+  ++pool->in_use;
+
+  return block;
+}
+
+void
+pool_free(Pool_t* pool, void* block)
+{
+  if (!block)
+    return;
+
+  pool_push_free(pool, block);
+  --pool->in_use;
+}
+
+void
+pool_reset(Pool_t* pool)
+{
+  pool->free_list = NULL;
+  pool->in_use    = 0;
+
+  for (size_t i = pool->slabs->end; i; --i)
+    pool_thread_slab(pool, (char*)vector_at(pool->slabs, i - 1));
+}
@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "include/err_utils.h"
+#include "include/i8254.h"
+#include "include/profiler.h"
+
+/* PRIVATE */
+static const char* const phase_names[PROF_NUM_PHASES] = {
+  [PROF_UPDATE] = "update",    [PROF_CLEAR] = "clear",
+  [PROF_COLLISIONS] = "colls", [PROF_POSITIONS] = "positions",
+  [PROF_RENDER] = "render",    [PROF_FLIP] = "flip",
+  [PROF_GC] = "gc"
+};
+
+/* ring of frame records (cycles spent in each phase) */
+static uint32_t records[PROF_FRAMES][PROF_NUM_PHASES];
+static uint32_t curr_record[PROF_NUM_PHASES]; /* frame being timed */
+static uint64_t began[PROF_NUM_PHASES];       /* start of each timed phase */
+static uint32_t frames_saved;                 /* total frames (not wrapped) */
+static uint64_t init_tsc, init_usecs;         /* for the TSC calibration */
+
+static uint64_t
+wall_usecs(void)
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static inline uint64_t
+read_tsc(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+  uint32_t lo, hi;
+  __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+  return ((uint64_t)hi << 32) | lo;
+#else
+  return wall_usecs(); // no TSC: count microseconds instead
+#endif
+}
+
+static uint64_t
+tsc_hz(void)
+{
+  /* cycles elapsed since prof_init over the (real) time elapsed since then */
+  uint64_t usecs = wall_usecs() - init_usecs;
+  if (!usecs)
+    return 0;
+  return (read_tsc() - init_tsc) * 1000000 / usecs;
+}
+
+static int
+cmp_cycles(const void* a, const void* b)
+{
+  uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+  return (x > y) - (x < y);
+}
+
+static void
+prof_atexit(void)
+{
+  prof_report();
+  if (prof_dump_trace(PROF_TRACE_FILE))
+    warn("%s: couldn't write the trace file %s", __func__, PROF_TRACE_FILE);
+}
+
+/* PUBLIC */
+void
+prof_init(void)
+{
+  memset(curr_record, 0, sizeof(curr_record));
+  frames_saved = 0;
+  init_usecs   = wall_usecs();
+  init_tsc     = read_tsc();
+
+  if (atexit(prof_atexit))
+    warn("%s: the profiling report won't be written", __func__);
+}
+
+void
+prof_begin(prof_phase phase)
+{
+  began[phase] = read_tsc();
+}
+
+void
+prof_end(prof_phase phase)
+{
+  curr_record[phase] += (uint32_t)(read_tsc() - began[phase]);
+}
+
+void
+prof_end_frame(void)
+{
+  memcpy(
+    records[frames_saved % PROF_FRAMES], curr_record, sizeof(curr_record));
+  memset(curr_record, 0, sizeof(curr_record));
+  ++frames_saved;
+}
+
+void
+prof_report(void)
+{
+  size_t n = frames_saved < PROF_FRAMES ? frames_saved : PROF_FRAMES;
+  if (!n)
+    return;
+
+  uint64_t hz = tsc_hz();
+  if (!hz)
+    return;
+  double budget = 1e6 / TIMER0_FREQ; // microseconds in a frame
+
+  warn("prof: %u frames (last %u shown), TSC at %.1f MHz",
+       frames_saved,
+       (unsigned)n,
+       hz / 1e6);
+  static uint32_t sorted[PROF_FRAMES];
+  for (size_t phase = 0; phase < PROF_NUM_PHASES; ++phase) {
+    for (size_t i = 0; i < n; ++i)
+      sorted[i] = records[i][phase];
+    qsort(sorted, n, sizeof(uint32_t), cmp_cycles);
+
+    double p50 = sorted[(n - 1) * 50 / 100] * 1e6 / hz;
+    double p99 = sorted[(n - 1) * 99 / 100] * 1e6 / hz;
+    double max = sorted[n - 1] * 1e6 / hz;
+    warn("prof: %-9s p50 %8.1f us  p99 %8.1f us  max %8.1f us  (p99 is %.1f%% "
+         "of a frame)",
+         phase_names[phase],
+         p50,
+         p99,
+         max,
+         p99 * 100 / budget);
+  }
+}
+
+int
+prof_dump_trace(const char* path)
+{
+  FILE* fp = fopen(path, "wb");
+  if (!fp)
+    return 1;
+
+  size_t n = frames_saved < PROF_FRAMES ? frames_saved : PROF_FRAMES;
+  Prof_Trace_Header_t header = { .magic      = PROF_TRACE_MAGIC,
+                                 .num_phases = PROF_NUM_PHASES,
+                                 .num_frames = n,
+                                 .first      = frames_saved - n,
+                                 .tsc_hz     = tsc_hz() };
+  int ret = fwrite(&header, sizeof(header), 1, fp) != 1;
+
+  /* oldest record first (the ring has wrapped if it is full) */
+  size_t oldest = frames_saved < PROF_FRAMES ? 0 : frames_saved % PROF_FRAMES;
+  for (size_t i = 0; i < n && !ret; ++i)
+    ret = fwrite(records[(oldest + i) % PROF_FRAMES],
+                 sizeof(records[0]),
+                 1,
+                 fp) != 1;
+
+  fclose(fp);
+  return ret;
+}
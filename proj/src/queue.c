@@ -1,13 +1,29 @@
 #include "include/queue.h"
 
 #include <stdlib.h>
+#include <string.h>
 
-struct node
+/* PRIVATE */
+static inline size_t
+queue_free_space(Queue_t* queue)
 {
-  uint8_t data;
-  struct node* next;
-};
+  return queue->capacity - queue_size(queue);
+}
+
+/* copy n bytes from the ring, starting at a given (free-running) position */
+static void
+queue_copy_out(Queue_t* queue, size_t pos, uint8_t* data, size_t n)
+{
+  size_t ind   = pos & (queue->capacity - 1);
+  size_t first = queue->capacity - ind; // bytes until the buffer wraps around
+  if (first > n)
+    first = n;
 
+  memcpy(data, queue->data + ind, first);
+  memcpy(data + first, queue->data, n - first);
+}
+
+/* PUBLIC */
 Queue_t*
 new_queue()
 {
@@ -15,9 +31,15 @@ new_queue()
   if (!queue)
     return NULL;
 
-  queue->back  = NULL;
-  queue->front = NULL;
-  queue->size  = 0;
+  queue->data = (uint8_t*)malloc(sizeof(uint8_t) * QUEUE_CAPACITY);
+  if (!queue->data) {
+    free(queue);
+    return NULL;
+  }
+
+  queue->capacity = QUEUE_CAPACITY;
+  queue->back     = 0;
+  queue->front    = 0;
 
   return queue;
 }
@@ -25,55 +47,85 @@ new_queue()
 bool
 queue_empty(Queue_t* queue)
 {
-  return queue->front == NULL;
+  return queue->front == queue->back;
+}
+
+size_t
+queue_size(Queue_t* queue)
+{
+  return queue->back - queue->front;
 }
 
 void
 queue_push(Queue_t* queue, uint8_t data)
 {
-  Node_t* node = (Node_t*)malloc(sizeof(Node_t));
-
-  if (!node)
+  if (!queue_free_space(queue))
     return;
 
-  node->data = data;
-  node->next = NULL;
+  queue->data[queue->back & (queue->capacity - 1)] = data;
+  ++queue->back;
+}
 
-  if (queue->back != NULL)
-    queue->back->next = node;
+size_t
+queue_push_n(Queue_t* queue, const uint8_t* data, size_t n)
+{
+  size_t free_space = queue_free_space(queue);
+  if (n > free_space)
+    n = free_space;
 
-  queue->back = node;
+  size_t ind   = queue->back & (queue->capacity - 1);
+  size_t first = queue->capacity - ind; // bytes until the buffer wraps around
+  if (first > n)
+    first = n;
 
-  if (queue_empty(queue))
-    queue->front = node;
+  memcpy(queue->data + ind, data, first);
+  memcpy(queue->data, data + first, n - first);
+  queue->back += n;
 
-  ++queue->size;
+  return n;
 }
 
 void
 queue_pop(Queue_t* queue)
 {
-  if (!queue_empty(queue)) {
-    if (queue->back == queue->front) // If queue only has one element
-      queue->back = NULL;
+  if (!queue_empty(queue))
+    ++queue->front;
+}
 
-    Node_t* toDel = queue->front;
-    queue->front  = queue->front->next;
-    free(toDel);
+size_t
+queue_pop_n(Queue_t* queue, uint8_t* data, size_t n)
+{
+  n = queue_peek_n(queue, data, n);
+  queue->front += n;
 
-    --queue->size;
-  }
+  return n;
+}
+
+size_t
+queue_peek_n(Queue_t* queue, uint8_t* data, size_t n)
+{
+  if (n > queue_size(queue))
+    n = queue_size(queue);
+
+  queue_copy_out(queue, queue->front, data, n);
+  return n;
 }
 
 uint8_t
 queue_front(Queue_t* queue)
 {
-  return queue->front->data;
+  if (queue_empty(queue))
+    return 0;
+
+  return queue->data[queue->front & (queue->capacity - 1)];
 }
 
 void
 queue_delete(Queue_t* queue)
 {
-  while (!queue_empty(queue))
-    queue_pop(queue);
+  if (!queue)
+    return;
+
+  free(queue->data);
+  free(queue);
 }
@@ -18,12 +18,14 @@ void
 serial_receive_delete()
 {
   queue_delete(receive_queue);
+  receive_queue = NULL;
 }
 
 void
 serial_send_delete()
 {
   queue_delete(send_queue);
+  send_queue = NULL;
 }
 
 bool
@@ -63,11 +65,12 @@ float
 serial_receive_read_float()
 {
   float2uint32 temp;
+  uint8_t bytes[4] = { 0 };
 
-  temp.i = serial_receive_read() << 24;
-  temp.i += serial_receive_read() << 16;
-  temp.i += serial_receive_read() << 8;
-  temp.i += serial_receive_read();
+  /* floats are sent MSB first */
+  queue_pop_n(receive_queue, bytes, 4);
+  temp.i = ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) |
+           ((uint32_t)bytes[2] << 8) | bytes[3];
 
   return temp.f;
 }
@@ -75,7 +78,7 @@ serial_receive_read_float()
 size_t
 serial_receive_size(void)
 {
-  return receive_queue->size;
+  return queue_size(receive_queue);
 }
 
 bool
@@ -93,18 +96,13 @@ serial_send_push(uint8_t data)
 void
 serial_send_push_int(uint32_t data)
 {
-  if (data == 0) { // still need to send padding
-    queue_push(send_queue, 0);
-    queue_push(send_queue, 0);
-    queue_push(send_queue, 0);
-    queue_push(send_queue, 0);
-    return;
-  }
+  /* send MSB first */
+  uint8_t bytes[4] = { (data & 0xFF000000) >> 24,
+                       (data & 0xFF0000) >> 16,
+                       (data & 0xFF00) >> 8,
+                       (data & 0xFF) };
 
-  queue_push(send_queue, (data & 0xFF000000) >> 24);
-  queue_push(send_queue, (data & 0xFF0000) >> 16);
-  queue_push(send_queue, (data & 0xFF00) >> 8);
-  queue_push(send_queue, (data & 0xFF));
+  queue_push_n(send_queue, bytes, 4);
 }
 
 void
@@ -255,7 +253,8 @@ serial_en_dataint(void)
     return 1;
 
   curr_conf |= IER_DATAINT;
-  receive_queue = new_queue();
+  if (!receive_queue && !(receive_queue = new_queue()))
+    return 1;
 
   return sys_outb(COM1_BASEADDR + UART_IER, curr_conf);
 }
@@ -282,7 +281,8 @@ serial_en_traholdint(void)
     return 1;
 
   curr_conf |= IER_TRAHOLDINT;
-  send_queue = new_queue();
+  if (!send_queue && !(send_queue = new_queue()))
+    return 1;
 
   return sys_outb(COM1_BASEADDR + UART_IER, curr_conf);
 }
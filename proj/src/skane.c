@@ -3,6 +3,7 @@
 
 #include "include/bmp.h"
 #include "include/err_utils.h"
+#include "include/obj_handle.h"
 #include "include/skane.h"
 
 /* PRIVATE */
@@ -49,6 +50,24 @@ update_dir(Skane_t* ska)
   }
 }
 
+static inline bool
+chain_diag_step(Skane_t* ska, direc dir, float speed, float* x, float* y)
+{
+  /* the tail moves one pixel diagonally per step, covering a cell sized square
+   * each time: the segment is the band of all those squares. Returns whether it
+   * goes down to the right (and the corner of its bounding box). */
+  int step_x = (dir == NE || dir == SE) ? -1 : 1;
+  int step_y = (dir == NE || dir == NW) ? 1 : -1;
+
+  float first_x = ska->t_x + step_x, first_y = ska->t_y + step_y;
+  ska->t_x += step_x * speed;
+  ska->t_y += step_y * speed;
+
+  *x = step_x > 0 ? first_x : ska->t_x;
+  *y = step_y > 0 ? first_y : ska->t_y;
+  return step_x == step_y;
+}
+
 static inline void
 chain_step(Skane_t* ska, seg* seg)
 {
@@ -89,49 +108,15 @@ chain_step(Skane_t* ska, seg* seg)
                 ska->ska_sprt.b_sprite.Data[0]);
       break;
     case NE:
-      for (size_t i = 0; i < speed; ++i) {
-        ++ska->t_y;
-        --ska->t_x;
-        DRAW_RECT(ska->t_x,
-                  ska->t_y,
-                  ska->cell_size,
-                  ska->cell_size,
-                  ska->ska_sprt.b_sprite.Data[0]);
-      }
-      break;
     case NW:
-      for (size_t i = 0; i < speed; ++i) {
-        ++ska->t_y;
-        ++ska->t_x;
-        DRAW_RECT(ska->t_x,
-                  ska->t_y,
-                  ska->cell_size,
-                  ska->cell_size,
-                  ska->ska_sprt.b_sprite.Data[0]);
-      }
-      break;
     case SE:
-      for (size_t i = 0; i < speed; ++i) {
-        --ska->t_y;
-        --ska->t_x;
-        DRAW_RECT(ska->t_x,
-                  ska->t_y,
-                  ska->cell_size,
-                  ska->cell_size,
-                  ska->ska_sprt.b_sprite.Data[0]);
-      }
-      break;
-    case SW:
-      for (size_t i = 0; i < speed; ++i) {
-        --ska->t_y;
-        ++ska->t_x;
-        DRAW_RECT(ska->t_x,
-                  ska->t_y,
-                  ska->cell_size,
-                  ska->cell_size,
-                  ska->ska_sprt.b_sprite.Data[0]);
-      }
+    case SW: {
+      float x, y;
+      bool down = chain_diag_step(ska, seg->dir, speed, &x, &y);
+      DRAW_BAND(
+        x, y, speed, ska->cell_size, down, ska->ska_sprt.b_sprite.Data[0]);
       break;
+    }
     default:
       /* STOP case */
       break;
@@ -141,8 +126,8 @@ chain_step(Skane_t* ska, seg* seg)
 static inline void
 chain_step_coll(Skane_Body_t* ska_body,
                 seg* seg,
-                vector* col_matrix,
-                vector* objs_to_ignore)
+                Broadphase_t* col_grid,
+                Hash_Set_t* objs_to_ignore)
 {
   Skane_t* ska = ska_body->ska;
 
@@ -153,7 +138,7 @@ chain_step_coll(Skane_Body_t* ska_body,
     case E:
       ska->t_x -= speed;
       updateCollisionMatrixRect(ska_body,
-                                col_matrix,
+                                col_grid,
                                 ska->t_x,
                                 ska->t_y,
                                 speed + 2,
@@ -162,7 +147,7 @@ chain_step_coll(Skane_Body_t* ska_body,
       break;
     case N:
       updateCollisionMatrixRect(ska_body,
-                                col_matrix,
+                                col_grid,
                                 ska->t_x,
                                 ska->t_y + ska->cell_size,
                                 ska->cell_size,
@@ -172,7 +157,7 @@ chain_step_coll(Skane_Body_t* ska_body,
       break;
     case W:
       updateCollisionMatrixRect(ska_body,
-                                col_matrix,
+                                col_grid,
                                 ska->t_x + ska->cell_size,
                                 ska->t_y,
                                 speed,
@@ -183,7 +168,7 @@ chain_step_coll(Skane_Body_t* ska_body,
     case S:
       ska->t_y -= speed;
       updateCollisionMatrixRect(ska_body,
-                                col_matrix,
+                                col_grid,
                                 ska->t_x,
                                 ska->t_y,
                                 ska->cell_size,
@@ -191,57 +176,15 @@ chain_step_coll(Skane_Body_t* ska_body,
                                 objs_to_ignore);
       break;
     case NE:
-      for (size_t i = 0; i < speed; ++i) {
-        ++ska->t_y;
-        --ska->t_x;
-        updateCollisionMatrixRect(ska_body,
-                                  col_matrix,
-                                  ska->t_x,
-                                  ska->t_y,
-                                  ska->cell_size,
-                                  ska->cell_size,
-                                  objs_to_ignore);
-      }
-      break;
     case NW:
-      for (size_t i = 0; i < speed; ++i) {
-        ++ska->t_y;
-        ++ska->t_x;
-        updateCollisionMatrixRect(ska_body,
-                                  col_matrix,
-                                  ska->t_x,
-                                  ska->t_y,
-                                  ska->cell_size,
-                                  ska->cell_size,
-                                  objs_to_ignore);
-      }
-      break;
     case SE:
-      for (size_t i = 0; i < speed; ++i) {
-        --ska->t_y;
-        --ska->t_x;
-        updateCollisionMatrixRect(ska_body,
-                                  col_matrix,
-                                  ska->t_x,
-                                  ska->t_y,
-                                  ska->cell_size,
-                                  ska->cell_size,
-                                  objs_to_ignore);
-      }
-      break;
-    case SW:
-      for (size_t i = 0; i < speed; ++i) {
-        --ska->t_y;
-        ++ska->t_x;
-        updateCollisionMatrixRect(ska_body,
-                                  col_matrix,
-                                  ska->t_x,
-                                  ska->t_y,
-                                  ska->cell_size,
-                                  ska->cell_size,
-                                  objs_to_ignore);
-      }
+    case SW: {
+      float x, y;
+      bool down = chain_diag_step(ska, seg->dir, speed, &x, &y);
+      updateCollisionMatrixBand(
+        ska_body, col_grid, x, y, speed, ska->cell_size, down, objs_to_ignore);
       break;
+    }
     default:
       /* STOP case */
       break;
@@ -259,91 +202,39 @@ printSkane(void* skane)
        ska->collision_direc,
        ska->curr_state);
 
-  for (size_t i = 0; i < ska->directions->end; ++i)
-    warn("%d %d",
-         ((seg*)vector_at(ska->directions, i))->dir,
-         ((seg*)vector_at(ska->directions, i))->len);
+  seg* curr_dir = NULL;
+  while ((curr_dir = deque_next(ska->directions, curr_dir)))
+    warn("%d %zu", curr_dir->dir, curr_dir->len);
   warn(" :\n");
 }
 
 static inline void
 add_seg(Skane_t* ska)
 {
-  seg* temp_seg = (seg*)malloc(sizeof(seg));
+  /* the segments are stored by value: no allocation once the ring fits */
+  seg* temp_seg = (seg*)deque_push_front(ska->directions);
   if (!temp_seg)
     return;
 
   temp_seg->len = 1;
   temp_seg->dir = ska->curr_state;
-  vector_insert(ska->directions, 0, (void*)temp_seg);
 }
 
+/* rotate the head to the current direction. Done on every step (drawn or not),
+ * because the collisions use the head sprite and the multiplayer sync sends
+ * the changes of direction */
 static void
-updateSkanePos(void* skane)
+update_head(Skane_t* ska)
 {
-  /* cast skane */
-  Skane_t* ska = (Skane_t*)skane;
-
-  /* take care of the head */
-  ska->curr_state -= ska->collision_direc;
-  ska->collision_direc = STOP;
-  update_dir(ska); // update current speed values based on state
-
-  /* update directions vector */
-  if (ska->curr_state != STOP) {
-    ska->obj->x += ska->obj->speed_x;
-    ska->obj->y += ska->obj->speed_y; // move head based on speed values
-
-    /* take care of the head */
-    seg* temp_seg = (seg*)vector_begin(ska->directions);
-    if (!temp_seg)
-      return;
-    if (temp_seg->dir == ska->curr_state)
-      ++temp_seg->len; // add another step in this direction
-    else
-      add_seg(ska); // add a new segment
-
-    /* get rid of the processed tail part */
-    temp_seg = vector_end(ska->directions);
-    --temp_seg->len;
-    if (!temp_seg->len)
-      vector_pop_and_free(ska->directions);
-  }
-
-  /* shooting cooldown */
-  if (ska->fire_cd)
-    --ska->fire_cd;
-}
-
-static void
-renderSkane(void* skane)
-{
-  Skane_t* ska = (Skane_t*)skane;
-
-  /* take care of the tail */
-  /* DRAW_SPRITE( */
-  /* &ska->ska_sprt.t_sprite, ska->t_x, ska->t_y, ska->obj->transparency); */
-
-  /* draw body pieces (right next to head, until tail) */
-  ska->t_x = ska->obj->x;
-  ska->t_y = ska->obj->y; // calculate new tail pos
-  seg* curr_dir;
-
-  for (size_t i = 0; i < ska->directions->end; ++i) {
-    curr_dir = ((seg*)vector_at(ska->directions, i));
-    chain_step(ska, curr_dir);
-  }
-
-  /* draw head */
   Sprite_t* new;
   /* no need to do these calculations if the Skane doesn't move */
   if (ska->draw_direc != ska->curr_state) {
     /* can't free the N head sprite (base one) */
     if (ska->ska_sprt.h_sprite.Data != ska->obj->sprite.Data &&
         ska->curr_state != STOP)
-      free(ska->obj->sprite.Data);
+      free_sprite(&ska->obj->sprite);
 
-    /* update last drawn state */
+    /* update the head's state */
     ska->draw_direc    = ska->curr_state;
     ska->changed_direc = true;
 
@@ -401,13 +292,71 @@ renderSkane(void* skane)
     /* change sprite */
     if (new) {
       ska->obj->sprite = *new;
-      free(new);
+      if (new != &ska->ska_sprt.h_sprite) // N uses the base sprite itself
+        free(new);
     }
   }
   else { // skane didn't change direction
     ska->changed_direc = false;
   }
+}
+
+static void
+updateSkanePos(void* skane)
+{
+  /* cast skane */
+  Skane_t* ska = (Skane_t*)skane;
+
+  /* take care of the head */
+  ska->curr_state -= ska->collision_direc;
+  ska->collision_direc = STOP;
+  update_dir(ska);  // update current speed values based on state
+  update_head(ska); // and the head sprite
+
+  /* update directions deque */
+  if (ska->curr_state != STOP) {
+    ska->obj->x += ska->obj->speed_x;
+    ska->obj->y += ska->obj->speed_y; // move head based on speed values
+
+    /* take care of the head */
+    seg* temp_seg = (seg*)deque_front(ska->directions);
+    if (!temp_seg)
+      return;
+    if (temp_seg->dir == ska->curr_state)
+      ++temp_seg->len; // add another step in this direction
+    else
+      add_seg(ska); // add a new segment
+
+    /* get rid of the processed tail part */
+    temp_seg = (seg*)deque_back(ska->directions);
+    --temp_seg->len;
+    if (!temp_seg->len)
+      deque_pop_back(ska->directions);
+  }
+
+  /* shooting cooldown */
+  if (ska->fire_cd)
+    --ska->fire_cd;
+}
 
+static void
+renderSkane(void* skane)
+{
+  Skane_t* ska = (Skane_t*)skane;
+
+  /* take care of the tail */
+  /* DRAW_SPRITE( */
+  /* &ska->ska_sprt.t_sprite, ska->t_x, ska->t_y, ska->obj->transparency); */
+
+  /* draw body pieces (right next to head, until tail) */
+  ska->t_x = ska->obj->x;
+  ska->t_y = ska->obj->y; // calculate new tail pos
+
+  seg* curr_dir = NULL;
+  while ((curr_dir = deque_next(ska->directions, curr_dir)))
+    chain_step(ska, curr_dir);
+
+  /* draw head */
   if (!ska->obj->sprite.Data) {
     warn("%s: Skane sprite broke.", __func__);
     return;
@@ -422,45 +371,51 @@ static void
 destroySka(void* skane)
 {
   Skane_t* ska = (Skane_t*)skane;
+  /* the N head sprite is the base one (freed below) */
+  if (ska->obj->sprite.Data == ska->ska_sprt.h_sprite.Data)
+    memset(&ska->obj->sprite, 0, sizeof(Sprite_t));
   ska->obj->vtable->destroy(ska->obj);
   free(ska->ska_body->obj);
   free(ska->ska_body);
-  free_vector_data(ska->directions);
-  free(ska->ska_sprt.h_sprite.Data);
-  free(ska->ska_sprt.b_sprite.Data);
-  free(ska->ska_sprt.t_sprite.Data);
-  free(ska->ska_sprt.m_sprite.Data);
-  free(ska->ska_sprt.f_sprite.Data);
-
-  for (size_t i = 0; i < ENE_ANIMCYCLE + ENE_ATK_ANIMCYCLE; ++i)
-    free(ska->ska_sprt.ene_sprite[i].Data);
-  free(ska->ska_sprt.ene_sprite);
+  free_deque(ska->directions);
+  free(ska->ediff);
+  free_flow_field(ska->flow);
+  free_sprite(&ska->ska_sprt.h_sprite);
+  free_sprite(&ska->ska_sprt.b_sprite);
+  free_sprite(&ska->ska_sprt.t_sprite);
+  free_sprite(&ska->ska_sprt.m_sprite);
+  free_sprite(&ska->ska_sprt.f_sprite);
+
+  for (size_t i = 0; i < ENE_ANIMCYCLE; ++i)
+    free_sprite(&ska->ska_sprt.ene_sprite[i]);
 
   free(ska);
 }
 
 static void
-updateCollisionSkane(void* skane, vector* col_matrix)
+updateCollisionSkane(void* skane, Broadphase_t* col_grid)
 {
   Skane_t* ska = (Skane_t*)skane;
-  ska->obj->vtable->updateCollision(ska, col_matrix);
-
-  /* Ignore skane head */
-  vector* objs_to_ignore = new_vector();
-  vector_push_back(objs_to_ignore, skane);
+  ska->obj->vtable->updateCollision(ska, col_grid);
 
   ska->t_x = ska->obj->x;
   ska->t_y = ska->obj->y; // calculate new tail pos
-  seg* curr_dir;
 
   /* Update skane collsion with other skane */
   if (ska->has_col_skane != 0)
     --ska->has_col_skane;
 
-  for (size_t i = 0; i < ska->directions->end; ++i) {
-    curr_dir = ((seg*)vector_at(ska->directions, i));
-    chain_step_coll(ska->ska_body, curr_dir, col_matrix, objs_to_ignore);
+  /* Ignore skane head */
+  Hash_Set_t* objs_to_ignore = new_hash_set(frame_arena());
+  if (!objs_to_ignore) {
+    warn("%s: Not enough memory to check the body collisions", __func__);
+    return;
   }
+  hash_set_insert(objs_to_ignore, skane);
+
+  seg* curr_dir = NULL;
+  while ((curr_dir = deque_next(ska->directions, curr_dir)))
+    chain_step_coll(ska->ska_body, curr_dir, col_grid, objs_to_ignore);
 }
 
 /* Skane Vtable */
@@ -485,8 +440,8 @@ new_skane(float x,
   if (!skane)
     return NULL;
 
-  /* allocate body segments vector */
-  skane->directions = new_vector();
+  /* allocate body segments deque */
+  skane->directions = new_deque(sizeof(seg));
   if (!skane->directions) {
     free(skane);
     return NULL;
@@ -495,7 +450,7 @@ new_skane(float x,
   /* reset skane's enemies difficulty */
   skane->ediff = (enemy_diff*)malloc(sizeof(enemy_diff));
   if (!skane->ediff) {
-    free_vector(skane->directions);
+    free_deque(skane->directions);
     free(skane);
     return NULL;
   }
@@ -504,11 +459,14 @@ new_skane(float x,
   skane->ediff->shots   = 0;
   skane->ediff->shotup  = 0;
 
+  /* the flow field to the skane needs the map (see create_map()) */
+  skane->flow = NULL;
+
   /* Sprite_t* new = sprite_cpy(&ska_sprt->h_sprite); */
   skane->obj = new_object(speed, speed, x, y, &ska_sprt->h_sprite);
   if (!skane->obj) {
     free(skane->ediff);
-    free_vector(skane->directions);
+    free_deque(skane->directions);
     free(skane);
     return NULL;
   }
@@ -536,16 +494,9 @@ new_skane(float x,
   skane->draw_direc    = STOP;
   skane->curr_state    = STOP; // skane starts stopped
   /* initial body segment */
-  seg* temp_seg = (seg*)malloc(sizeof(seg));
-  if (!temp_seg) {
-    free_vector(skane->directions);
-    free(skane);
-    return NULL;
-  }
-
-  temp_seg->len = health;
+  seg* temp_seg = (seg*)deque_push_back(skane->directions);
+  temp_seg->len = health; // the deque has room for its first segment
   temp_seg->dir = N;
-  vector_push_back(skane->directions, (void*)temp_seg);
   skane->collision_direc = STOP;
   skane->has_col_skane   = 0;
 
@@ -560,34 +511,41 @@ new_skane(float x,
   skane->t_y = y + 2 * skane->cell_size;
 
   /* id */
-  static size_t curr_id       = 1;
-  skane->obj->identifier.id   = curr_id;
   skane->obj->identifier.type = SKANE;
-  ++curr_id;
 
-  /* Create skane's body obj to write in col_matrix */
+  /* Create skane's body obj to write in the collision grid */
   Skane_Body_t* ska_body = (Skane_Body_t*)malloc(sizeof(Skane_Body_t));
   if (!ska_body) {
-    free_vector(skane->directions);
+    free_deque(skane->directions);
     free(skane);
-    free(temp_seg);
     return NULL;
   }
   Object_t* body_obj = new_object(0, 0, 0, 0, NULL);
   if (!body_obj) {
-    free_vector(skane->directions);
+    free_deque(skane->directions);
     free(skane);
-    free(temp_seg);
     free(ska_body);
     return NULL;
   }
   ska_body->obj                  = body_obj;
   ska_body->ska                  = skane;
   ska_body->vtable               = NULL;
-  ska_body->obj->identifier.id   = skane->obj->identifier.id;
   ska_body->obj->identifier.type = SKANE_BODY;
   skane->ska_body                = ska_body;
 
+  /* the body shares the id of its skane */
+  skane->obj->identifier.id    = new_obj_id(skane);
+  ska_body->obj->identifier.id = skane->obj->identifier.id;
+  if (!skane->obj->identifier.id) {
+    free(body_obj);
+    free(ska_body);
+    free(skane->obj);
+    free(skane->ediff);
+    free_deque(skane->directions);
+    free(skane);
+    return NULL;
+  }
+
   skane->vtable = &skane_vtable;
   return skane;
 }
@@ -631,7 +589,7 @@ skane_nom(Skane_t* ska, uint16_t nourishment)
   /* ska->s += 0.1; */
 
   /* get bigger */
-  ((seg*)vector_end(ska->directions))->len += nourishment;
+  ((seg*)deque_back(ska->directions))->len += nourishment;
   ska->health += nourishment;
 }
 
@@ -643,7 +601,7 @@ skane_unom(Skane_t* ska, uint8_t damage)
 
   ska->health -= damage;
   for (uint8_t i = damage; i; --i) {
-    seg* temp_seg = (seg*)vector_end(ska->directions);
+    seg* temp_seg = (seg*)deque_back(ska->directions);
     if (!temp_seg) {
       warn("%s: Failed getting skane segment", __func__);
       return 0;
@@ -654,13 +612,13 @@ skane_unom(Skane_t* ska, uint8_t damage)
       break;
     }
     else if (temp_seg->len == i) {
-      vector_pop_and_free(ska->directions);
+      deque_pop_back(ska->directions);
       break;
     }
     else { // temp_seg->len < i
       i -= temp_seg->len;
       ++i; // couteract the for loop decrement
-      vector_pop_and_free(ska->directions);
+      deque_pop_back(ska->directions);
     }
   }
 
@@ -672,7 +630,7 @@ skane_take_damage(Skane_t* ska, uint8_t damage)
 {
   /* we become smaller if we take damage */
   if (skane_unom(ska, damage)) {
-    ska->obj->identifier.id = 0; // tell the game the skane died
+    kill_object(ska->obj); // tell the game the skane died
     return;
   }
 }
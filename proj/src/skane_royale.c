@@ -22,7 +22,8 @@ static int
 print_usage()
 {
   printf(
-    "Usage: <resources path - string> <mode - hex>\n");
+    "Usage: <resources path - string> <mode - hex> <seed - uint> "
+    "[headless|ramfb]\n");
   return 1;
 }
 
@@ -34,9 +35,27 @@ int(proj_main_loop)(int argc, char* argv[])
   /* read configs */
   if (argc != 0) {
     uint16_t mode;
+    unsigned seed;
     char path[256];
 
     switch (argc) {
+      case 4: // simulation only (no drawing) or system memory back buffer
+        if (!strcmp(argv[3], "headless"))
+          set_headless();
+        else if (!strcmp(argv[3], "ramfb"))
+          set_ram_buff();
+        else {
+          printf("%s: invalid option (%s).\n", __func__, argv[3]);
+          return print_usage();
+        }
+        /* fall through */
+      case 3: // random seed
+        if (sscanf(argv[2], "%u", &seed) != 1) {
+          printf("%s: invalid seed (%s).\n", __func__, argv[2]);
+          return print_usage();
+        }
+        set_seed(seed);
+        /* fall through */
       case 2: // video mode
         if (sscanf(argv[1], "%hx", &mode) != 1) {
           printf("%s: invalid mode (%s).\n", __func__, argv[2]);
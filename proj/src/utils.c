@@ -3,6 +3,12 @@
 
 #include "include/utils.h"
 
+/* EXTERNAL DEFINITIONS OF THE INLINE FUNCTIONS */
+extern inline float slope_calc(const int x, const int y);
+extern inline double fmabs(const double x);
+extern inline void fskip(FILE* fp, uint32_t num_bytes);
+extern inline void fskip_until(FILE* fp, char search_byte);
+
 /* INTERRUPT (UN)SUBSCRIBE */
 int
 subscribe_int(int* bit_no, int irq_line, bool is_exclusive)
@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <string.h>
 
 #include "include/vector.h"
 
@@ -164,30 +165,16 @@ vector_at(vector* vec, size_t i)
 void
 vector_insert(vector* vec, size_t i, void* elem)
 {
-  if (i >= vec->end)
+  if (i > vec->end)
     return;
 
-  /* alloc new data array */
-  void** tempvec;
-  if (vec->end == vec->size) {
-    tempvec = (void**)malloc(sizeof(void*) * vec->size * 2);
-    vec->size *= 2;
-  }
-  else
-    tempvec = (void**)malloc(sizeof(void*) * vec->size);
-
-  /* move elements until the the index to insert */
-  for (size_t j = 0; j < i; ++j) {
-    tempvec[j] = vec->data[j];
-  }
-  tempvec[i] = elem;
-
-  for (size_t j = i; j < vec->end; ++j) {
-    tempvec[j + 1] = vec->data[j];
-  }
+  /* double alloced space if it is exhausted */
+  if (vec->end == vec->size)
+    vector_realloc(vec, vec->size ? vec->size * 2 : DFLT_VEC_SIZE);
 
-  free(vec->data);
-  vec->data = tempvec;
+  /* shift the elements after the index one position to the right */
+  memmove(vec->data + i + 1, vec->data + i, sizeof(void*) * (vec->end - i));
+  vec->data[i] = elem;
   ++vec->end;
 }
 
@@ -198,16 +185,36 @@ vector_delete(vector* vec, size_t i)
   if (i >= vec->end)
     return;
 
-  void** tempvec = (void**)malloc(sizeof(void*) * vec->size);
-  for (size_t j = 0; j < i; ++j) {
-    tempvec[j] = vec->data[j];
-  }
+  /* shift the elements after the index one position to the left */
+  memmove(
+    vec->data + i, vec->data + i + 1, sizeof(void*) * (vec->end - i - 1));
+  vector_pop_back(vec);
+}
 
-  for (size_t j = i + 1; j < vec->end; ++j) {
-    tempvec[j - 1] = vec->data[j];
+/* delete element at given index (last element takes its place) */
+void
+vector_swap_remove(vector* vec, size_t i)
+{
+  if (i >= vec->end)
+    return;
+
+  vec->data[i] = vec->data[vec->end - 1];
+  vector_pop_back(vec);
+}
+
+/* delete all elements matching a given predicate (keeps the order) */
+size_t
+vector_remove_if(vector* vec, bool (*pred)(void*))
+{
+  size_t new_end = 0;
+  for (size_t i = 0; i < vec->end; ++i) {
+    if (!pred(vec->data[i]))
+      vec->data[new_end++] = vec->data[i];
   }
 
-  free(vec->data);
-  vec->data = tempvec;
-  --vec->end;
+  size_t removed = vec->end - new_end;
+  while (vec->end > new_end)
+    vector_pop_back(vec);
+
+  return removed;
 }
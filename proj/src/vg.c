@@ -9,8 +9,20 @@
 #include "include/vg_def.h"
 #include "include/vg_utils.h"
 
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 #define RGB8TO6(x) ((63 * x) / 255)
 
+/* EXTERNAL DEFINITIONS OF THE INLINE FUNCTIONS */
+extern inline uint8_t r_color(uint32_t color, uint8_t RedLSB);
+extern inline uint8_t g_color(uint32_t color, uint8_t RedLSB, uint8_t GreenLSB);
+extern inline uint8_t b_color(uint32_t color,
+                              uint8_t RedLSB,
+                              uint8_t GreenLSB,
+                              uint8_t BlueLSB);
+
 /* PRIVATE */
 /* VG CLASS DATA MEMBERS */
 static void* show_buff;  /* Process' address where VRAM is mapped */
@@ -25,9 +37,144 @@ static unsigned bytespixel;    /* Number of VRAM bytes per pixel */
 static unsigned vram_size;     /* Total syze of vram */
 static uint8_t
   memory_model;    /* memory color mode (packed pixel, direct, etc...) */
-static bool vsync; /* whether ot not to use vsync */
+static bool vsync;          /* whether ot not to use vsync */
+static bool headless;       /* don't touch video memory (nothing is drawn) */
+static void* ram_buff;      /* back buffer in system memory (or NULL) */
+static void* draw_buff;     /* where frames are drawn (write or ram buff) */
+static unsigned draw_pitch; /* Size of a line of draw_buff, in pixels */
 /* END VG CLASS DATA MEMBERS */
 
+/* SPRITE ROW BLITTERS */
+/* Copy the non-transparent pixels of a sprite row. Blocks of pixels are tested
+ * at once: fully opaque blocks are copied with a single store, fully
+ * transparent ones are skipped and only the mixed ones (the sprite's edges) are
+ * copied pixel by pixel. The video memory is never read. */
+typedef void (*blit_row_t)(uint8_t* dst,
+                           const uint8_t* src,
+                           size_t npix,
+                           uint32_t transp);
+static blit_row_t blit_row; /* blitter for the current mode's pixel size */
+
+typedef uintptr_t blit_word_t; /* native word (SWAR blocks) */
+
+/* copy the runs of opaque bytes set in a mask (bit i is byte i, not all set) */
+static inline void
+blit_opaque_runs(uint8_t* dst, const uint8_t* src, uint32_t opaque)
+{
+  while (opaque) {
+    unsigned beg = __builtin_ctz(opaque);
+    unsigned len = __builtin_ctz(~(opaque >> beg)); // whole pixels
+    memcpy(dst + beg, src + beg, len);
+    opaque &= ~((((uint64_t)1 << len) - 1) << beg);
+  }
+}
+
+/* blitter for pixels of 1, 2 or 4 bytes (bpp is constant after inlining) */
+static inline void
+blit_row_lanes(uint8_t* dst,
+               const uint8_t* src,
+               size_t npix,
+               uint32_t transp,
+               const size_t bpp)
+{
+  size_t len = npix * bpp, i = 0;
+  if (bpp < 4)
+    transp &= (1u << (8 * bpp)) - 1;
+
+#ifdef __AVX2__
+  const __m256i transp_v = bpp == 1   ? _mm256_set1_epi8((char)transp)
+                           : bpp == 2 ? _mm256_set1_epi16((short)transp)
+                                      : _mm256_set1_epi32((int)transp);
+  for (; i + 32 <= len; i += 32) {
+    __m256i pix = _mm256_loadu_si256((const __m256i*)(src + i));
+    __m256i eq  = bpp == 1   ? _mm256_cmpeq_epi8(pix, transp_v)
+                  : bpp == 2 ? _mm256_cmpeq_epi16(pix, transp_v)
+                             : _mm256_cmpeq_epi32(pix, transp_v);
+    uint32_t opaque = ~(uint32_t)_mm256_movemask_epi8(eq);
+    if (opaque == UINT32_MAX)
+      _mm256_storeu_si256((__m256i*)(dst + i), pix);
+    else
+      blit_opaque_runs(dst + i, src + i, opaque);
+  }
+#endif
+#ifdef __SSE2__
+  const __m128i transp_x = bpp == 1   ? _mm_set1_epi8((char)transp)
+                           : bpp == 2 ? _mm_set1_epi16((short)transp)
+                                      : _mm_set1_epi32((int)transp);
+  for (; i + 16 <= len; i += 16) {
+    __m128i pix = _mm_loadu_si128((const __m128i*)(src + i));
+    __m128i eq  = bpp == 1   ? _mm_cmpeq_epi8(pix, transp_x)
+                  : bpp == 2 ? _mm_cmpeq_epi16(pix, transp_x)
+                             : _mm_cmpeq_epi32(pix, transp_x);
+    uint32_t opaque = ~(uint32_t)_mm_movemask_epi8(eq) & 0xFFFF;
+    if (opaque == 0xFFFF)
+      _mm_storeu_si128((__m128i*)(dst + i), pix);
+    else
+      blit_opaque_runs(dst + i, src + i, opaque);
+  }
+#endif
+
+  /* SWAR: the top bit of each lane (pixel) ends up set if it is opaque */
+  const blit_word_t ones =
+    (blit_word_t)-1 / ((blit_word_t)-1 >> (8 * (sizeof(blit_word_t) - bpp)));
+  const blit_word_t top      = ones << (8 * bpp - 1);
+  const blit_word_t low      = top - ones;
+  const blit_word_t transp_w = ones * transp;
+  for (; i + sizeof(blit_word_t) <= len; i += sizeof(blit_word_t)) {
+    blit_word_t pix;
+    memcpy(&pix, src + i, sizeof(pix));
+    blit_word_t diff   = pix ^ transp_w; // zero lanes are transparent
+    blit_word_t opaque = (((diff & low) + low) | diff) & top;
+    if (opaque == top)
+      memcpy(dst + i, &pix, sizeof(pix));
+    else if (opaque) {
+      for (size_t k = 0; k < sizeof(pix); k += bpp) // little endian lanes
+        if ((opaque >> (8 * k)) & ((blit_word_t)1 << (8 * bpp - 1)))
+          memcpy(dst + i + k, src + i + k, bpp);
+    }
+  }
+
+  /* leftover pixels */
+  for (; i < len; i += bpp) {
+    uint32_t pix = 0;
+    memcpy(&pix, src + i, bpp);
+    if (pix != transp)
+      memcpy(dst + i, src + i, bpp);
+  }
+}
+
+static void
+blit_row_8(uint8_t* dst, const uint8_t* src, size_t npix, uint32_t transp)
+{
+  blit_row_lanes(dst, src, npix, transp, 1);
+}
+
+static void
+blit_row_16(uint8_t* dst, const uint8_t* src, size_t npix, uint32_t transp)
+{
+  blit_row_lanes(dst, src, npix, transp, 2);
+}
+
+static void
+blit_row_24(uint8_t* dst, const uint8_t* src, size_t npix, uint32_t transp)
+{
+  /* pixels straddle any block size: test them one at a time */
+  transp &= 0xFFFFFF;
+  for (; npix; --npix, dst += 3, src += 3) {
+    if ((src[0] | (uint32_t)src[1] << 8 | (uint32_t)src[2] << 16) != transp) {
+      dst[0] = src[0];
+      dst[1] = src[1];
+      dst[2] = src[2];
+    }
+  }
+}
+
+static void
+blit_row_32(uint8_t* dst, const uint8_t* src, size_t npix, uint32_t transp)
+{
+  blit_row_lanes(dst, src, npix, transp, 4);
+}
+
 static bool
 is_2nd_buff(void)
 {
@@ -35,6 +182,448 @@ is_2nd_buff(void)
   return (show_buff > write_buff);
 }
 
+/* DISPLAY LIST (DAMAGE TRACKING) */
+/* draw_sprite_i() and draw_rect_i() only record what is drawn. When the frame
+ * is done (next_buff()), its list is compared with the last list drawn to the
+ * back buffer (the buffers take turns, so each one remembers its own): only the
+ * areas where they differ, merged into a few rects, are cleared and redrawn. */
+#define DIRTY_RECTS_MAX   32 /* more rects than this are merged together */
+#define DIRTY_RECTS_SLACK 8  /* rects this close are merged (fewer, bigger) */
+
+typedef struct
+{
+  unsigned x0, y0, x1, y1; /* [x0, x1[ x [y0, y1[ */
+} vg_rect_t;
+
+typedef enum
+{
+  CMD_SPRITE,
+  CMD_RECT,
+  CMD_BAND_DOWN, /* squares at (x + i, y + i) */
+  CMD_BAND_UP    /* squares at (x + len - 1 - i, y + i) */
+} draw_cmd_type_t;
+
+typedef struct
+{
+  uint8_t type;        /* draw_cmd_type_t */
+  Sprite_t sprite;     /* sprite to draw */
+  uint32_t key;        /* id of the sprite's pixels (0: unknown) or color */
+  uint16_t x, y, w, h; /* bounding box (w and h are clipped to the screen) */
+  uint16_t len, size;  /* number and side of the squares of a band */
+  uint8_t transp;      /* transparent color of the sprite */
+} draw_cmd_t;
+
+typedef struct
+{
+  draw_cmd_t* cmds;
+  size_t len, size;
+  bool valid; /* whether the buffer is showing this list */
+} draw_list_t;
+
+static draw_list_t draw_lists[3];
+static draw_list_t* frame_list   = &draw_lists[0]; /* frame being drawn */
+static draw_list_t* buff_list[2] = { &draw_lists[1], &draw_lists[2] };
+static bool draw_buff_tainted; /* drawn to outside of the display list */
+/* rects of the last frame (copied to both VRAM pages when drawing to RAM) */
+static vg_rect_t last_rects[DIRTY_RECTS_MAX];
+static size_t num_last_rects;
+
+/* STATIC BACKGROUND */
+/* Image (h_res x v_res, in system memory) restored where the frame is
+ * redrawn, instead of clearing it. It holds what never changes (e.g.: the
+ * map), so it costs a copy of the dirty rects, whatever it contains. */
+static uint8_t* bkg;
+static bool bkg_drawing; /* draw_*_i draw to the background (not recorded) */
+
+static void
+invalidate_buffs(void)
+{
+  /* what the buffers show must be redrawn from scratch */
+  buff_list[0]->valid = false;
+  buff_list[1]->valid = false;
+}
+
+static size_t
+write_buff_ind(void)
+{
+  return write_buff > show_buff;
+}
+
+static size_t
+draw_buff_ind(void)
+{
+  /* the system memory buffer is never flipped */
+  return ram_buff ? 0 : write_buff_ind();
+}
+
+static void
+record_cmd(const draw_cmd_t* cmd)
+{
+  if (frame_list->len == frame_list->size) {
+    size_t size = frame_list->size ? frame_list->size * 2 : 256;
+    draw_cmd_t* cmds =
+      (draw_cmd_t*)realloc(frame_list->cmds, size * sizeof(draw_cmd_t));
+    if (!cmds) {
+      warn("%s: display list allocation failed", __func__);
+      return;
+    }
+
+    frame_list->cmds = cmds;
+    frame_list->size = size;
+  }
+
+  frame_list->cmds[frame_list->len++] = *cmd;
+}
+
+static inline uint32_t
+cmd_hash(const draw_cmd_t* cmd)
+{
+  uint32_t h = cmd->key * 2654435761u;
+  h ^= ((uint32_t)cmd->x << 16 | cmd->y) * 2246822519u;
+  h ^= ((uint32_t)cmd->w << 16 | cmd->h) * 3266489917u;
+  return h ^ (h >> 15);
+}
+
+static inline bool
+cmd_equal(const draw_cmd_t* a, const draw_cmd_t* b)
+{
+  /* sprites without an id can't be told apart (they are always redrawn) */
+  return a->type == b->type && a->key == b->key && a->x == b->x &&
+         a->y == b->y && a->w == b->w && a->h == b->h && a->len == b->len &&
+         a->size == b->size && a->transp == b->transp &&
+         (a->key || a->type != CMD_SPRITE);
+}
+
+static inline vg_rect_t
+cmd_rect(const draw_cmd_t* cmd)
+{
+  vg_rect_t r = { cmd->x, cmd->y, cmd->x + cmd->w, cmd->y + cmd->h };
+  return r;
+}
+
+static inline bool
+rects_intersect(const vg_rect_t* a, const vg_rect_t* b, unsigned slack)
+{
+  return a->x0 < b->x1 + slack && b->x0 < a->x1 + slack &&
+         a->y0 < b->y1 + slack && b->y0 < a->y1 + slack;
+}
+
+static inline void
+rect_union(vg_rect_t* r, const vg_rect_t* other)
+{
+  if (other->x0 < r->x0)
+    r->x0 = other->x0;
+  if (other->y0 < r->y0)
+    r->y0 = other->y0;
+  if (other->x1 > r->x1)
+    r->x1 = other->x1;
+  if (other->y1 > r->y1)
+    r->y1 = other->y1;
+}
+
+static inline size_t
+rect_area(const vg_rect_t* r)
+{
+  return (size_t)(r->x1 - r->x0) * (r->y1 - r->y0);
+}
+
+static void
+add_dirty_rect(vg_rect_t* rects, size_t* num_rects, vg_rect_t r)
+{
+  if (r.x0 >= r.x1 || r.y0 >= r.y1)
+    return; // nothing to redraw
+
+  /* merge with the rects close to it (the merged rect may reach others) */
+  for (size_t i = 0; i < *num_rects;) {
+    if (rects_intersect(&rects[i], &r, DIRTY_RECTS_SLACK)) {
+      rect_union(&r, &rects[i]);
+      rects[i] = rects[--*num_rects];
+      i        = 0;
+    }
+    else
+      ++i;
+  }
+
+  if (*num_rects < DIRTY_RECTS_MAX) {
+    rects[(*num_rects)++] = r;
+    return;
+  }
+
+  /* too many rects: grow the one that grows the least */
+  size_t best = 0, best_growth = SIZE_MAX;
+  for (size_t i = 0; i < *num_rects; ++i) {
+    vg_rect_t merged = rects[i];
+    rect_union(&merged, &r);
+    size_t growth = rect_area(&merged) - rect_area(&rects[i]);
+    if (growth < best_growth) {
+      best        = i;
+      best_growth = growth;
+    }
+  }
+  rect_union(&rects[best], &r);
+}
+
+static size_t
+list_damage(const draw_list_t* old_list,
+            const draw_list_t* new_list,
+            vg_rect_t* rects)
+{
+  /* hash table of the old commands (open addressing, indexes plus one) */
+  static uint32_t* table;
+  static bool* matched;
+  static size_t table_size, matched_size;
+
+  size_t size = 64;
+  while (size < old_list->len * 2)
+    size <<= 1;
+  if (size > table_size) {
+    free(table);
+    table_size = 0;
+    if (!(table = (uint32_t*)malloc(size * sizeof(uint32_t))))
+      goto full_screen;
+    table_size = size;
+  }
+  if (old_list->len > matched_size) {
+    free(matched);
+    matched_size = 0;
+    if (!(matched = (bool*)malloc(old_list->len * sizeof(bool))))
+      goto full_screen;
+    matched_size = old_list->len;
+  }
+
+  size_t mask = size - 1;
+  memset(table, 0, size * sizeof(uint32_t));
+  if (old_list->len)
+    memset(matched, 0, old_list->len * sizeof(bool));
+  for (size_t i = 0; i < old_list->len; ++i) {
+    size_t h = cmd_hash(&old_list->cmds[i]) & mask;
+    while (table[h])
+      h = (h + 1) & mask;
+    table[h] = i + 1;
+  }
+
+  /* the new commands that were already drawn, in the same order, are kept */
+  size_t num_rects = 0, last_kept = 0;
+  for (size_t i = 0; i < new_list->len; ++i) {
+    const draw_cmd_t* cmd = &new_list->cmds[i];
+    size_t h              = cmd_hash(cmd) & mask;
+    for (; table[h]; h = (h + 1) & mask) {
+      size_t j = table[h] - 1;
+      if (!matched[j] && cmd_equal(&old_list->cmds[j], cmd)) {
+        matched[j] = true;
+        break;
+      }
+    }
+
+    /* a command drawn before one it used to be drawn after must be redrawn
+     * (they may overlap) */
+    if (table[h] && table[h] > last_kept) {
+      last_kept = table[h];
+      continue;
+    }
+    add_dirty_rect(rects, &num_rects, cmd_rect(cmd));
+  }
+
+  /* the old commands that weren't drawn again must be erased */
+  for (size_t i = 0; i < old_list->len; ++i)
+    if (!matched[i])
+      add_dirty_rect(rects, &num_rects, cmd_rect(&old_list->cmds[i]));
+
+  return num_rects;
+
+full_screen:
+  warn("%s: damage tracking allocation failed", __func__);
+  rects[0] = (vg_rect_t){ 0, 0, h_res, v_res };
+  return 1;
+}
+
+static void
+draw_cmd_clipped(const draw_cmd_t* cmd,
+                 const vg_rect_t* clip,
+                 uint8_t* buff,
+                 size_t stride)
+{
+  /* part of the command inside the clip rect (they must intersect) */
+  size_t col_beg = clip->x0 > cmd->x ? clip->x0 - cmd->x : 0;
+  size_t row_beg = clip->y0 > cmd->y ? clip->y0 - cmd->y : 0;
+  size_t col_end = clip->x1 - cmd->x < cmd->w ? clip->x1 - cmd->x : cmd->w;
+  size_t row_end = clip->y1 - cmd->y < cmd->h ? clip->y1 - cmd->y : cmd->h;
+
+  uint8_t* pixel_pointer = buff + ((cmd->y + row_beg) * stride + cmd->x);
+
+  /* filled rect */
+  if (cmd->type == CMD_RECT) {
+    for (size_t row = row_beg; row < row_end; ++row) {
+      memset(pixel_pointer + col_beg, (uint8_t)cmd->key, col_end - col_beg);
+      pixel_pointer += stride;
+    }
+    return;
+  }
+
+  /* 45 degree band: each row is covered by the consecutive squares [beg, end]
+   * (one span, each pixel written once) */
+  if (cmd->type != CMD_SPRITE) {
+    for (size_t row = row_beg; row < row_end; ++row) {
+      size_t beg = row + 1 > cmd->size ? row + 1 - cmd->size : 0;
+      size_t end = row < cmd->len ? row : cmd->len - 1u;
+      size_t x0  = cmd->type == CMD_BAND_DOWN ? beg : cmd->len - 1u - end;
+      size_t x1  = cmd->type == CMD_BAND_DOWN ? end : cmd->len - 1u - beg;
+      x1 += cmd->size;
+
+      if (x0 < col_beg)
+        x0 = col_beg;
+      if (x1 > col_end)
+        x1 = col_end;
+      if (x0 < x1)
+        memset(pixel_pointer + x0, (uint8_t)cmd->key, x1 - x0);
+      pixel_pointer += stride;
+    }
+    return;
+  }
+
+  const Sprite_t* sprite = &cmd->sprite;
+  uint8_t* sprite_ptr    = sprite->Data + row_beg * sprite->Width;
+
+  /* precomputed opaque spans: only copy those (transparent rows are skipped) */
+  if (sprite->Spans && sprite->Spans->Transp == cmd->transp) {
+    const Sprite_Spans_t* spans = sprite->Spans;
+    for (size_t row = row_beg; row < row_end; ++row) {
+      for (uint32_t i = spans->RowStart[row]; i < spans->RowStart[row + 1];
+           ++i) {
+        const Sprite_Span_t* span = &spans->Spans[i];
+        if (span->Start >= col_end)
+          break; // the remaining spans are outside of the clip rect
+
+        size_t beg = span->Start > col_beg ? span->Start : col_beg;
+        size_t end = span->Start + span->Len;
+        if (end > col_end)
+          end = col_end;
+        if (beg < end)
+          memcpy(pixel_pointer + beg, sprite_ptr + beg, end - beg);
+      }
+
+      pixel_pointer += stride;
+      sprite_ptr += sprite->Width;
+    }
+    return;
+  }
+
+  for (size_t row = row_beg; row < row_end; ++row) {
+    /* copy data to given video memory, skipping the transparent pixels */
+    blit_row_8(pixel_pointer + col_beg,
+               sprite_ptr + col_beg,
+               col_end - col_beg,
+               cmd->transp);
+
+    pixel_pointer += stride;
+    sprite_ptr += sprite->Width;
+  }
+}
+
+static size_t
+repair_draw_buff(vg_rect_t* rects)
+{
+  /* find what changed since the back buffer was last drawn */
+  const draw_list_t* shown = buff_list[draw_buff_ind()];
+  size_t num_rects;
+  if (shown->valid)
+    num_rects = list_damage(shown, frame_list, rects);
+  else {
+    rects[0]  = (vg_rect_t){ 0, 0, h_res, v_res };
+    num_rects = 1;
+  }
+
+  /* restore the background and redraw (in order) everything inside the dirty
+   * rects */
+  for (size_t i = 0; i < num_rects; ++i) {
+    const vg_rect_t* rect = &rects[i];
+    size_t width          = rect->x1 - rect->x0;
+    uint8_t* reset_ptr =
+      (uint8_t*)draw_buff + (rect->y0 * draw_pitch + rect->x0);
+    if (bkg) {
+      const uint8_t* bkg_ptr = bkg + (rect->y0 * h_res + rect->x0);
+      for (size_t y = rect->y0; y < rect->y1; ++y) {
+        memcpy(reset_ptr, bkg_ptr, width);
+        reset_ptr += draw_pitch;
+        bkg_ptr += h_res;
+      }
+    }
+    else {
+      for (size_t y = rect->y0; y < rect->y1; ++y) {
+        memset(reset_ptr, 0, width);
+        reset_ptr += draw_pitch;
+      }
+    }
+
+    for (size_t j = 0; j < frame_list->len; ++j) {
+      vg_rect_t cmd_r = cmd_rect(&frame_list->cmds[j]);
+      if (rects_intersect(&cmd_r, rect, 0))
+        draw_cmd_clipped(
+          &frame_list->cmds[j], rect, (uint8_t*)draw_buff, draw_pitch);
+    }
+  }
+
+  return num_rects;
+}
+
+static void
+stream_copy(uint8_t* dst, const uint8_t* src, size_t len)
+{
+#ifdef __SSE2__
+  /* non-temporal stores of whole cache lines: VRAM is written around the
+   * caches (partial lines would be flushed one store at a time) */
+  size_t head = -(uintptr_t)dst & 63;
+  if (len >= head + 64) {
+    memcpy(dst, src, head);
+    dst += head, src += head, len -= head;
+    for (; len >= 64; len -= 64, dst += 64, src += 64)
+      for (size_t i = 0; i < 64; i += 16)
+        _mm_stream_si128((__m128i*)(dst + i),
+                         _mm_loadu_si128((const __m128i*)(src + i)));
+  }
+#endif
+  memcpy(dst, src, len);
+}
+
+static void
+push_ram_buff(const vg_rect_t* rects, size_t num_rects)
+{
+  /* the VRAM page shows the frame before the last one: it misses the changes
+   * of both frames */
+  vg_rect_t push[DIRTY_RECTS_MAX];
+  size_t num_push = 0;
+  for (size_t i = 0; i < num_rects; ++i)
+    add_dirty_rect(push, &num_push, rects[i]);
+  for (size_t i = 0; i < num_last_rects; ++i)
+    add_dirty_rect(push, &num_push, last_rects[i]);
+
+  for (size_t i = 0; i < num_push; ++i) {
+    size_t len = (push[i].x1 - push[i].x0) * bytespixel;
+    for (size_t y = push[i].y0; y < push[i].y1; ++y)
+      stream_copy((uint8_t*)write_buff +
+                    (y * scanline_pix + push[i].x0) * bytespixel,
+                  (uint8_t*)ram_buff + (y * h_res + push[i].x0) * bytespixel,
+                  len);
+  }
+#ifdef __SSE2__
+  _mm_sfence(); // the page is complete before it is shown
+#endif
+
+  memcpy(last_rects, rects, num_rects * sizeof(vg_rect_t));
+  num_last_rects = num_rects;
+}
+
+static void
+submit_cmd(const draw_cmd_t* cmd)
+{
+  if (bkg_drawing) {
+    vg_rect_t screen = { 0, 0, h_res, v_res };
+    draw_cmd_clipped(cmd, &screen, bkg, h_res);
+  }
+  else
+    record_cmd(cmd); // drawn when the frame is done (see next_buff())
+}
+
 static int
 vg_alloc_2nd_buff(void)
 {
@@ -49,6 +638,12 @@ vg_alloc_2nd_buff(void)
   /* start at the second buffer */
   write_buff = (void*)((uint8_t*)show_buff + h_res);
 
+  /* draw to VRAM (a system memory buffer has the size of the old mode) */
+  free(ram_buff);
+  ram_buff   = NULL;
+  draw_buff  = write_buff;
+  draw_pitch = scanline_pix;
+
   return 0;
 }
 
@@ -107,20 +702,98 @@ get_memory_model(void)
 void
 vg_clear(void)
 {
-  uint8_t* reset_ptr = (uint8_t*)write_buff;
+  if (headless)
+    return;
+
+  uint8_t* reset_ptr = (uint8_t*)draw_buff;
   for (size_t i = v_res; i > 0; --i) {
     memset(reset_ptr, 0, h_res);
-    reset_ptr += scanline_pix;
+    reset_ptr += draw_pitch;
   }
+
+  /* the buffer is now showing an empty list (without the background), the
+   * VRAM pages behind a system memory buffer still show the old frames */
+  buff_list[draw_buff_ind()]->len   = 0;
+  buff_list[draw_buff_ind()]->valid = !bkg && !ram_buff;
 }
 
 void
 vg_clear_all(void)
 {
+  if (headless)
+    return;
+
   if (is_2nd_buff())
     memset(write_buff, 0, vram_size * 2);
   else
     memset(show_buff, 0, vram_size * 2);
+  if (ram_buff)
+    memset(ram_buff, 0, vram_size);
+  num_last_rects = 0;
+
+  for (size_t i = 0; i < 2; ++i) {
+    buff_list[i]->len   = 0;
+    buff_list[i]->valid = !bkg;
+  }
+}
+
+int
+vg_set_ram_buff(bool enable)
+{
+  if (enable && !ram_buff && !(ram_buff = calloc(vram_size, 1))) {
+    warn("%s: system memory back buffer allocation failed", __func__);
+    return 1;
+  }
+  if (!enable) {
+    free(ram_buff);
+    ram_buff = NULL;
+  }
+
+  draw_buff  = ram_buff ? ram_buff : write_buff;
+  draw_pitch = ram_buff ? h_res : scanline_pix;
+  invalidate_buffs(); // nothing is known about the new buffer
+  return 0;
+}
+
+int
+vg_bkg_begin(void)
+{
+  if (headless)
+    return 1; // nothing would be drawn
+
+  if (!bkg && !(bkg = (uint8_t*)malloc(h_res * v_res))) {
+    warn("%s: background allocation failed", __func__);
+    return 1;
+  }
+
+  memset(bkg, 0, h_res * v_res);
+  bkg_drawing = true;
+  return 0;
+}
+
+void
+vg_bkg_end(void)
+{
+  bkg_drawing = false;
+  invalidate_buffs();
+}
+
+void
+vg_bkg_free(void)
+{
+  if (!bkg)
+    return;
+
+  bkg_drawing = false;
+  free(bkg);
+  bkg = NULL;
+  invalidate_buffs();
+}
+
+void
+vg_set_headless(bool no_draw)
+{
+  headless = no_draw;
 }
 
 int
@@ -221,6 +894,15 @@ set_random_color_palette(uint8_t palette_size, uint8_t first_color_ind)
 void
 next_buff(void)
 {
+  if (headless) // the shown buffer never changes
+    return;
+
+  /* draw the frame (only what changed since this buffer was last shown) */
+  vg_rect_t rects[DIRTY_RECTS_MAX];
+  size_t num_rects = repair_draw_buff(rects);
+  if (ram_buff)
+    push_ram_buff(rects, num_rects);
+
   /* let vga know about the switch */
   if (is_2nd_buff()) { // return to initial state
     if (vbe_set_display_start(0, 0, vsync))
@@ -231,13 +913,21 @@ next_buff(void)
       die("olha falhei\n");
   }
 
+  /* the drawn buffer keeps the frame's list, the old one is reused */
+  size_t ind         = draw_buff_ind();
+  draw_list_t* drawn = frame_list;
+  frame_list         = buff_list[ind];
+  frame_list->len    = 0;
+  drawn->valid       = !draw_buff_tainted;
+  buff_list[ind]     = drawn;
+  draw_buff_tainted  = false;
+
   /* switch video pointers */
   void* temp_video = show_buff;
   show_buff        = write_buff;
   write_buff       = temp_video;
-
-  // vg_show2write();
-  vg_clear();
+  if (!ram_buff)
+    draw_buff = write_buff;
 }
 
 void*
@@ -247,6 +937,22 @@ vginit(uint16_t mode, bool v_sync)
   if (vg_save_mode_info(mode))
     return NULL;
 
+  /* pick the sprite blitter for this mode's pixel size */
+  switch (bytespixel) {
+    case 1:
+      blit_row = blit_row_8;
+      break;
+    case 2:
+      blit_row = blit_row_16;
+      break;
+    case 3:
+      blit_row = blit_row_24;
+      break;
+    default:
+      blit_row = blit_row_32;
+      break;
+  }
+
   /* set privileges for the mode buffer (2 buffers) */
   if (privctl(physbaseptr, vram_size * 2)) {
     warn("%s: video memory privilege setting failed", __func__);
@@ -332,10 +1038,11 @@ draw_line(uint16_t x, uint16_t y, uint32_t color, uint16_t len)
    * the specified size and color.
    * Checks if the line fits in the given mode resolution
    */
+  draw_buff_tainted = true; // drawn outside of the display list
 
   /* calculate starting video memory writting position */
   uint8_t* pixel_pointer =
-    (uint8_t*)write_buff + (y * scanline_pix + x) * bytespixel;
+    (uint8_t*)draw_buff + (y * draw_pitch + x) * bytespixel;
 
   size_t h_lim; // part of the line that isn't drawn
   if ((h_lim = h_res - x) > len)
@@ -358,9 +1065,11 @@ draw_rect(uint16_t x,
    * Checks if the rectangle fits in the given mode resolution.
    */
 
-  if (x >= h_res || y >= v_res) // no need to verify y outside loop because
-                                // outside loop verifies it
-    return;                     // nothing to draw
+  /* no need to verify y outside loop because outside loop verifies it */
+  if (headless || x >= h_res || y >= v_res)
+    return; // nothing to draw
+
+  draw_buff_tainted = true; // drawn outside of the display list
 
   size_t v_lim; // part of the line that isn't drawn
   if ((v_lim = v_res - y) > height)
@@ -383,12 +1092,14 @@ draw_sprite_notransp(Sprite_t* sprite, const uint16_t x, const uint16_t y)
   }
 
   /* stop if there will be nothing to draw (already finished) */
-  if (x >= h_res || y >= v_res)
+  if (headless || x >= h_res || y >= v_res)
     return;
 
+  draw_buff_tainted = true; // drawn outside of the display list
+
   /* initialize video memory pointer at the correct position for writting */
   uint8_t* pixel_pointer =
-    (uint8_t*)write_buff + (y * scanline_pix + x) * bytespixel;
+    (uint8_t*)draw_buff + (y * draw_pitch + x) * bytespixel;
 
   /* draws while checking to not draw out of the screen resolution */
   uint8_t* sprite_ptr = sprite->Data; // get sprite data location
@@ -409,7 +1120,7 @@ draw_sprite_notransp(Sprite_t* sprite, const uint16_t x, const uint16_t y)
            sprite_ptr,
            h_lim * bytespixel); // copy data to given video memory
     /* skip pointers to the next line */
-    pixel_pointer += (scanline_pix * bytespixel);
+    pixel_pointer += (draw_pitch * bytespixel);
     sprite_ptr += sprite->Width;
   }
 }
@@ -429,12 +1140,14 @@ draw_sprite(Sprite_t* sprite,
   }
 
   /* stop if there will be nothing to draw (already finished) */
-  if (x >= h_res || y >= v_res)
+  if (headless || x >= h_res || y >= v_res)
     return;
 
+  draw_buff_tainted = true; // drawn outside of the display list
+
   /* initialize video memory pointer at the correct position for writting */
   uint8_t* pixel_pointer =
-    (uint8_t*)write_buff + (y * scanline_pix + x) * bytespixel;
+    (uint8_t*)draw_buff + (y * draw_pitch + x) * bytespixel;
 
   /* get the sprite data pointer and how long horizontal lines are */
   uint8_t* sprite_ptr = sprite->Data; // get sprite data location
@@ -450,25 +1163,14 @@ draw_sprite(Sprite_t* sprite,
   if ((h_lim = h_res - x) > sprite->Width)
     h_lim = sprite->Width;
 
-  /* how much to skip pointers on line change */
-  size_t pixel_ptr_skip  = (scanline_pix - h_lim) * bytespixel;
-  size_t sprite_ptr_skip = (sprite->Width - h_lim) * bytespixel;
-
   /* draws while checking to not draw out of the screen resolution */
-  for (size_t i = y; i < (sprite->Height + y) && i < v_res; ++i) {
-    for (size_t j = 0; j < h_lim; ++j) {
-      /* copy data to given video memory, if it is not a transparent pixel */
-      if (memcmp(sprite_ptr, &transp, bytespixel))
-        memcpy(pixel_pointer, sprite_ptr, bytespixel);
-
-      /* advance pointers to next pixel */
-      pixel_pointer += bytespixel;
-      sprite_ptr += bytespixel;
-    }
+  for (; v_lim; --v_lim) {
+    /* copy data to given video memory, skipping the transparent pixels */
+    blit_row(pixel_pointer, sprite_ptr, h_lim, transp);
 
-    pixel_pointer += pixel_ptr_skip;
+    pixel_pointer += draw_pitch * bytespixel;
     /* skip sprite data that was going to be drawn outside the screen */
-    sprite_ptr += sprite_ptr_skip;
+    sprite_ptr += sprite->Width * bytespixel;
   }
 }
 
@@ -488,12 +1190,14 @@ draw_sprite_ovr(Sprite_t* sprite,
   }
 
   /* stop if there will be nothing to draw (already finished) */
-  if (x >= h_res || y >= v_res)
+  if (headless || x >= h_res || y >= v_res)
     return;
 
+  draw_buff_tainted = true; // drawn outside of the display list
+
   /* initialize video memory pointer at the correct position for writting */
   uint8_t* pixel_pointer =
-    (uint8_t*)write_buff + (y * scanline_pix + x) * bytespixel;
+    (uint8_t*)draw_buff + (y * draw_pitch + x) * bytespixel;
 
   /* get the sprite data pointer and how long horizontal lines are */
   uint8_t* sprite_ptr = sprite->Data; // get sprite data location
@@ -510,7 +1214,7 @@ draw_sprite_ovr(Sprite_t* sprite,
     h_lim = sprite->Width;
 
   /* how much to skip pointers on line change */
-  size_t pixel_ptr_skip  = (scanline_pix - h_lim) * bytespixel;
+  size_t pixel_ptr_skip  = (draw_pitch - h_lim) * bytespixel;
   size_t sprite_ptr_skip = (sprite->Width - h_lim) * bytespixel;
 
   /* draws while checking to not draw out of the screen resolution */
@@ -545,26 +1249,47 @@ draw_rect_i(uint16_t x,
    * Checks if the rectangle fits in the given mode resolution.
    */
 
-  if (x >= h_res || y >= v_res)
+  if (headless || x >= h_res || y >= v_res)
     return; // nothing to draw
 
-  size_t v_lim; // lines that aren't drawn
-  if ((v_lim = v_res - y) > height)
-    v_lim = height;
-
-  size_t h_lim; // part of the line that isn't drawn
-  if ((h_lim = h_res - x) > width)
-    h_lim = width;
+  draw_cmd_t cmd = {
+    .type = CMD_RECT, .key = color, .x = x, .y = y, .w = width, .h = height
+  };
+  if (cmd.w > h_res - x)
+    cmd.w = h_res - x;
+  if (cmd.h > v_res - y)
+    cmd.h = v_res - y;
+  submit_cmd(&cmd);
+}
 
-  /* calculate starting video memory writting position */
-  uint8_t* pixel_pointer = (uint8_t*)write_buff + (y * scanline_pix + x);
+void
+draw_band_i(uint16_t x,
+            uint16_t y,
+            uint16_t len,
+            uint16_t size,
+            bool down,
+            uint8_t color)
+{
+  /* Draws a 45 degree band of squares (each one is offset by one pixel in
+   * both directions from the previous one).
+   */
 
-  for (; v_lim; --v_lim) {
-    for (size_t j = h_lim; j; --j)
-      pixel_pointer[j - 1] = color;
+  if (headless || x >= h_res || y >= v_res || !len || !size)
+    return; // nothing to draw
 
-    pixel_pointer += scanline_pix;
-  }
+  draw_cmd_t cmd = { .type = down ? CMD_BAND_DOWN : CMD_BAND_UP,
+                     .key  = color,
+                     .x    = x,
+                     .y    = y,
+                     .w    = len - 1 + size,
+                     .h    = len - 1 + size,
+                     .len  = len,
+                     .size = size };
+  if (cmd.w > h_res - x)
+    cmd.w = h_res - x;
+  if (cmd.h > v_res - y)
+    cmd.h = v_res - y;
+  submit_cmd(&cmd);
 }
 
 void
@@ -575,7 +1300,7 @@ draw_sprite_i(Sprite_t* sprite,
 {
   /* draws a sprite at the given coordinates */
   /* stop if there will be nothing to draw (already finished) */
-  if (x >= h_res || y >= v_res)
+  if (headless || x >= h_res || y >= v_res)
     return;
 
   /* check if the given sprite data is ok */
@@ -584,35 +1309,19 @@ draw_sprite_i(Sprite_t* sprite,
     return;
   }
 
-  /* initialize video memory pointer at the correct position for writting */
-  uint8_t* pixel_pointer = (uint8_t*)write_buff + (y * scanline_pix + x);
-
-  /* get the sprite data pointer and how long horizontal lines are */
-  uint8_t* sprite_ptr = sprite->Data; // get sprite data location
-
-  /* calculate limits */
-  size_t v_lim; // part of the image that isn't drawn (is out of screen v_res),
-                // if any
-  if ((v_lim = v_res - y) > sprite->Height)
-    v_lim = sprite->Height;
-
-  size_t h_lim; // part of the image that isn't drawn (is out of screen h_res),
-                // if any
-  if ((h_lim = h_res - x) > sprite->Width)
-    h_lim = sprite->Width;
-
-  /* draws while checking to not draw out of the screen resolution */
-  for (; v_lim; --v_lim) {
-    for (size_t j = h_lim; j; --j) {
-      /* copy data to given video memory, if it is not a transparent pixel */
-      if (sprite_ptr[j - 1] != transp)
-        pixel_pointer[j - 1] = sprite_ptr[j - 1];
-    }
-
-    pixel_pointer += scanline_pix;
-    /* skip sprite data that was going to be drawn outside the screen */
-    sprite_ptr += sprite->Width;
-  }
+  draw_cmd_t cmd = { .type   = CMD_SPRITE,
+                     .sprite = *sprite,
+                     .key    = sprite->Spans ? sprite->Spans->Id : 0,
+                     .x      = x,
+                     .y      = y,
+                     .w      = sprite->Width,
+                     .h      = sprite->Height,
+                     .transp = transp };
+  if (sprite->Width > h_res - x)
+    cmd.w = h_res - x;
+  if (sprite->Height > v_res - y)
+    cmd.h = v_res - y;
+  submit_cmd(&cmd);
 }
 
 void
@@ -624,9 +1333,11 @@ draw_sprite_ovr_i(Sprite_t* sprite,
 {
   /* draws a sprite at the given coordinates */
   /* stop if there will be nothing to draw (already finished) */
-  if (x >= h_res || y >= v_res)
+  if (headless || x >= h_res || y >= v_res)
     return;
 
+  draw_buff_tainted = true; // drawn outside of the display list
+
   /* check if the given sprite data is ok */
   if (!sprite || !sprite->Data) {
     warn("%s: Unitialized pointers", __func__);
@@ -634,7 +1345,7 @@ draw_sprite_ovr_i(Sprite_t* sprite,
   }
 
   /* initialize video memory pointer at the correct position for writting */
-  uint8_t* pixel_pointer = (uint8_t*)write_buff + (y * scanline_pix + x);
+  uint8_t* pixel_pointer = (uint8_t*)draw_buff + (y * draw_pitch + x);
 
   /* get the sprite data pointer and how long horizontal lines are */
   uint8_t* sprite_ptr = sprite->Data; // get sprite data location
@@ -660,7 +1371,7 @@ draw_sprite_ovr_i(Sprite_t* sprite,
         pixel_pointer[j - 1] = bkg;
     }
 
-    pixel_pointer += scanline_pix;
+    pixel_pointer += draw_pitch;
     /* skip sprite data that was going to be drawn outside the screen */
     sprite_ptr += sprite->Width;
   }
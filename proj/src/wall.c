@@ -1,5 +1,6 @@
 #include "include/wall.h"
 #include "include/err_utils.h"
+#include "include/obj_handle.h"
 
 /* VIRTUAL METHODS */
 static void
@@ -42,17 +43,21 @@ renderWall(void* w)
 }
 
 static void
-updateCollisionWall(void* w, vector* col_matrix)
+updateCollisionWall(void* w, Broadphase_t* col_grid)
 {
-  Wall_t* wall          = (Wall_t*)w;
-  uint16_t curr_y       = (uint16_t)wall->obj->y;
-  vector* collided_objs = new_vector();
+  Wall_t* wall              = (Wall_t*)w;
+  uint16_t curr_y           = (uint16_t)wall->obj->y;
+  Hash_Set_t* collided_objs = new_hash_set(frame_arena());
+  if (!collided_objs) {
+    warn("%s: Not enough memory to check the collisions", __func__);
+    return;
+  }
 
   for (size_t i = 0; i < wall->height; ++i) {
     uint16_t curr_x = (uint16_t)wall->obj->x;
     for (size_t j = 0; j < wall->length; ++j) {
       updateCollisionMatrix(
-        w, col_matrix, curr_x, curr_y, &wall->obj->sprite, collided_objs);
+        w, col_grid, curr_x, curr_y, &wall->obj->sprite, collided_objs);
       curr_x += wall->obj->sprite.Width;
     }
     curr_y += wall->obj->sprite.Height;
@@ -88,10 +93,13 @@ new_wall(float x,
   wall->length = length;
   wall->height = height;
 
-  static int8_t curr_id      = 1;
-  wall->obj->identifier.id   = curr_id;
+  wall->obj->identifier.id   = new_obj_id(wall);
   wall->obj->identifier.type = WALL;
   wall->type                 = type;
-  ++curr_id;
+  if (!wall->obj->identifier.id) {
+    free(obj);
+    free(wall);
+    return NULL;
+  }
   return wall;
 }